@@ -45,6 +45,8 @@
 
 #include <gdiplus.h>
 
+#include <wincodec.h>
+
 #include <shlwapi.h>
 
 #include <uxtheme.h>
@@ -62,6 +64,7 @@
 #include <memory>
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include <random>
 
@@ -80,6 +83,7 @@
 #include <thread>
 #include <functional>
 #include <deque>
+#include <chrono>
 
 
 // Fix for min/max macros
@@ -96,6 +100,17 @@
 
 #endif
 
+#include "src/core/grouping_engine.h"
+#include "src/core/string_pool.h"
+#include "src/core/model_cache.h"
+#include "src/core/path_analysis.h"
+#include "src/core/radix_sort.h"
+#include "src/core/search_index.h"
+#include "src/core/jump_index.h"
+#include "src/core/image_probe.h"
+#include "src/core/resample.h"
+#include "src/core/content_hash.h"
+
 
 
 // Core API implementations provided by foobar2000_component_client.lib
@@ -110,6 +125,8 @@ using std::max;
 
 #pragma comment(lib, "gdiplus.lib")
 
+#pragma comment(lib, "windowscodecs.lib")
+
 #pragma comment(lib, "user32.lib")
 
 #pragma comment(lib, "shlwapi.lib")
@@ -371,7 +388,7 @@ namespace shutdown_protection {
     }
 }
 
-// Simple fixed thread pool for thumbnail loading
+// Simple fixed thread pool for thumbnail loading and model rebuilds
 class ThreadPool {
 public:
     explicit ThreadPool(size_t n) : m_stop(false) {
@@ -396,18 +413,22 @@ public:
         m_cv.notify_one();
     }
 private:
+    // v10.0.52: Workers are in the MTA for their lifetime, so tasks can use COM
+    // (WIC in decode_jpeg_at_scale())
     void worker() {
+        const HRESULT com = CoInitializeEx(NULL, COINIT_MULTITHREADED);
         for (;;) {
             std::function<void()> task;
             {
                 std::unique_lock<std::mutex> lk(m_mtx);
                 m_cv.wait(lk, [&]{ return m_stop || !m_tasks.empty(); });
-                if (m_stop && m_tasks.empty()) return;
+                if (m_stop && m_tasks.empty()) break;
                 task = std::move(m_tasks.front());
                 m_tasks.pop_front();
             }
             try { task(); } catch(...) {}
         }
+        if (SUCCEEDED(com)) CoUninitialize();
     }
     std::vector<std::thread> m_workers;
     std::deque<std::function<void()>> m_tasks;
@@ -799,6 +820,99 @@ struct grid_config {
         SORT_BY_RATING,
         SORT_BY_RELEASE_DATE
     };
+    // v10.0.52: Item order - sort fields compared in turn, each ascending or
+    // descending. Whatever they leave tied goes by group key, so the order is total
+    // and a refresh reproduces it exactly. sort_spec(mode) is the menu's "By ..."
+    // order; a random spec is SORT_BY_RANDOM alone. Up to three fields, as many as
+    // the Sort menu sets (By, Then By, And Then By), each with its direction.
+    struct sort_key { sort_mode field; bool descending; };
+    struct sort_spec {
+        static const int max_keys = 3;
+        int count = 1;
+        sort_key keys[max_keys] = { { SORT_BY_NAME, false } };
+
+        sort_spec() = default;
+        explicit sort_spec(sort_mode field) {
+            keys[0] = { field, descending_by_default(field) };
+            if (field == SORT_BY_RELEASE_DATE) {  // same release: newest file, then name
+                keys[1] = { SORT_BY_DATE, true };
+                keys[2] = { SORT_BY_NAME, false };
+                count = 3;
+            }
+        }
+
+        // Dates, sizes, counts and ratings list the largest first
+        static bool descending_by_default(sort_mode field) {
+            switch (field) {
+                case SORT_BY_DATE: case SORT_BY_TRACK_COUNT: case SORT_BY_YEAR: case SORT_BY_SIZE:
+                case SORT_BY_RATING: case SORT_BY_RELEASE_DATE:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        sort_mode primary() const { return keys[0].field; }
+        bool is_random() const { return keys[0].field == SORT_BY_RANDOM; }
+
+        // Field at position 1 or 2 in its default direction, following the fields
+        // before it; SORT_BY_RANDOM drops it and the ones after it. A field already
+        // used before the position is refused, and one used after it is dropped there.
+        void set_then_by(int position, sort_mode field) {
+            if (is_random() || position < 1 || position >= max_keys || position > count) return;
+            for (int i = 0; i < position; i++) {
+                if (keys[i].field == field) return;
+            }
+            if (field == SORT_BY_RANDOM) {
+                count = position;
+                return;
+            }
+            keys[position] = { field, descending_by_default(field) };
+            int kept = position + 1;
+            for (int i = position + 1; i < count; i++) {
+                if (keys[i].field != field) keys[kept++] = keys[i];
+            }
+            count = kept;
+        }
+
+        void set_descending(int position, bool descending) {
+            if (!is_random() && position >= 0 && position < count) keys[position].descending = descending;
+        }
+
+        bool is_valid() const {
+            if (count < 1 || count > max_keys) return false;
+            for (int i = 0; i < count; i++) {
+                if ((int)keys[i].field < 0 || (int)keys[i].field > SORT_BY_RELEASE_DATE) return false;
+                if (keys[i].field == SORT_BY_RANDOM && (i > 0 || count > 1)) return false;
+            }
+            return true;
+        }
+
+        // Compact identity of the order (never 0): 3 bits of count, then 5 per key
+        uint32_t id() const {
+            uint32_t out = (uint32_t)count;
+            for (int i = 0; i < count; i++) {
+                out |= (((uint32_t)keys[i].field & 15) | (keys[i].descending ? 16u : 0u)) << (3 + 5 * i);
+            }
+            return out;
+        }
+
+        static bool from_id(uint32_t id, sort_spec& out) {
+            sort_spec spec;
+            spec.count = (int)(id & 7);
+            if (spec.count < 1 || spec.count > max_keys || (id >> (3 + 5 * spec.count)) != 0) return false;
+            for (int i = 0; i < spec.count; i++) {
+                const uint32_t bits = id >> (3 + 5 * i);
+                spec.keys[i] = { (sort_mode)(bits & 15), (bits & 16) != 0 };
+            }
+            if (!spec.is_valid()) return false;
+            out = spec;
+            return true;
+        }
+
+        bool operator==(const sort_spec& other) const { return id() == other.id(); }
+        bool operator!=(const sort_spec& other) const { return id() != other.id(); }
+    };
 
     enum track_sort_mode { TRACK_SORT_BY_NUMBER = 0, TRACK_SORT_BY_NAME = 1, TRACK_SORT_NONE = 2 };
     track_sort_mode track_sorting = TRACK_SORT_BY_NUMBER;
@@ -808,20 +922,21 @@ struct grid_config {
     enum label_format { LABEL_ALBUM_ONLY = 0, LABEL_ARTIST_ONLY = 1, LABEL_ARTIST_ALBUM = 2, LABEL_FOLDER_NAME = 3 };
     enum artwork_scale_mode { ARTWORK_STRETCH = 0, ARTWORK_FIT = 1, ARTWORK_CROP = 2 };
 
-    int columns; int text_lines; bool show_text; bool show_track_count; int font_size; group_mode grouping; sort_mode sorting; view_mode view; doubleclick_action doubleclick; label_format label_style; bool auto_scroll_to_now_playing; enum enlarged_mode { ENLARGED_NONE = 0, ENLARGED_2X2 = 1, ENLARGED_3X3 = 2 }; enlarged_mode enlarged_now_playing; bool show_playlist_overlay; artwork_scale_mode artwork_scale;
+    int columns; int text_lines; bool show_text; bool show_track_count; int font_size; group_mode grouping; sort_spec sorting; view_mode view; doubleclick_action doubleclick; label_format label_style; bool auto_scroll_to_now_playing; enum enlarged_mode { ENLARGED_NONE = 0, ENLARGED_2X2 = 1, ENLARGED_3X3 = 2 }; enlarged_mode enlarged_now_playing; bool show_playlist_overlay; artwork_scale_mode artwork_scale;
 
     grid_config() : columns(5), text_lines(2), show_text(true), show_track_count(true), font_size(11), grouping(GROUP_BY_FOLDER), sorting(SORT_BY_NAME), view(VIEW_LIBRARY), doubleclick(DOUBLECLICK_PLAY), label_style(LABEL_ALBUM_ONLY), auto_scroll_to_now_playing(false), enlarged_now_playing(ENLARGED_NONE), show_playlist_overlay(false), artwork_scale(ARTWORK_FIT) {}
 
     ui_element_config::ptr save(const GUID& guid) {
         struct Header { uint32_t magic; uint16_t ver; uint16_t reserved; };
         constexpr uint32_t MAGIC = 0x43474141; // 'A''A''G''C'
-        Header h{MAGIC, 2, 0};
+        Header h{MAGIC, 3, 0};
         std::vector<uint8_t> buf; buf.reserve(128);
         auto append = [&](auto v){ uint8_t* p = reinterpret_cast<uint8_t*>(&v); buf.insert(buf.end(), p, p+sizeof(v)); };
         append(h);
         append(columns); append(text_lines); append(show_text); append(show_track_count); append(font_size);
-        append(grouping); append(sorting); append(view); append(doubleclick); append(label_style);
+        append(grouping); append(sorting.primary()); append(view); append(doubleclick); append(label_style);
         append(auto_scroll_to_now_playing); append(enlarged_now_playing); append(show_playlist_overlay); append(artwork_scale);
+        append(sorting.id());  // v3: full sort specification; older readers keep the primary above
         return ui_element_config::g_create(guid, buf.data(), (t_size)buf.size());
     }
 
@@ -835,14 +950,18 @@ struct grid_config {
             if (magic == 0x43474141 && ver >= 1) {
                 size_t off = 8; auto read=[&](auto& out){ if (off+sizeof(out) <= sz) { memcpy(&out, data+off, sizeof(out)); off+=sizeof(out);} };
                 read(columns); read(text_lines); read(show_text); read(show_track_count); read(font_size);
-                read(grouping); read(sorting); read(view); read(doubleclick); read(label_style);
+                sort_mode primary = SORT_BY_NAME;
+                read(grouping); read(primary); read(view); read(doubleclick); read(label_style);
                 read(auto_scroll_to_now_playing); read(enlarged_now_playing); read(show_playlist_overlay);
                 if (ver >= 2) read(artwork_scale); else artwork_scale = ARTWORK_FIT;
+                if ((int)primary < 0 || (int)primary > SORT_BY_RELEASE_DATE) primary = SORT_BY_NAME;
+                uint32_t sort_id = 0;
+                if (ver >= 3) read(sort_id);
+                if (!sort_spec::from_id(sort_id, sorting) || sorting.primary() != primary) sorting = sort_spec(primary);
                 columns = std::max(1, columns); text_lines = std::max(1, std::min(3, text_lines)); font_size = std::max(7, std::min(14, font_size));
                 if ((int)view < 0 || (int)view > VIEW_PLAYLIST) view = VIEW_LIBRARY;
                 if ((int)doubleclick < 0 || (int)doubleclick > DOUBLECLICK_PLAY_IN_GRID) doubleclick = DOUBLECLICK_PLAY;
                 if ((int)label_style < 0 || (int)label_style > LABEL_FOLDER_NAME) label_style = LABEL_ALBUM_ONLY;
-                if ((int)sorting < 0 || (int)sorting > SORT_BY_RELEASE_DATE) sorting = SORT_BY_NAME;
                 if ((int)artwork_scale < 0 || (int)artwork_scale > ARTWORK_CROP) artwork_scale = ARTWORK_FIT;
                 return;
             }
@@ -854,7 +973,7 @@ struct grid_config {
             columns = std::max(1, tmp.columns); text_lines = std::max(1, std::min(3, tmp.text_lines));
             show_text = tmp.show_text; show_track_count = tmp.show_track_count; font_size = std::max(7, std::min(14, tmp.font_size));
             grouping = (group_mode)std::clamp(tmp.grouping, 0, (int)GROUP_BY_RATING);
-            sorting = (sort_mode)std::clamp(tmp.sorting, 0, (int)SORT_BY_RELEASE_DATE);
+            sorting = sort_spec((sort_mode)std::clamp(tmp.sorting, 0, (int)SORT_BY_RELEASE_DATE));
             view = (view_mode)std::clamp(tmp.view, 0, (int)VIEW_PLAYLIST);
             doubleclick = (doubleclick_action)std::clamp(tmp.doubleclick, 0, (int)DOUBLECLICK_PLAY_IN_GRID);
             label_style = (label_format)std::clamp(tmp.label_style, 0, (int)LABEL_FOLDER_NAME);
@@ -864,6 +983,22 @@ struct grid_config {
 };
 
 
+// v10.0.52: A cover decoded at a power-of-two level (thumbnail_data::level_for()).
+// Shared by every thumbnail whose artwork has the same bytes (thumbnail_cache::find_level()),
+// each resampling its own cell-sized bitmap from it. The cache counts its memory once,
+// from remember_level() until the last thumbnail lets go of it.
+struct artwork_level {
+    Gdiplus::Bitmap* bitmap = nullptr;
+    int size = 0;
+    uint64_t content = 0;     // xxh3_64() of the encoded artwork
+    size_t encoded_size = 0;
+    size_t memory_size = 0;   // what thumbnail_cache charged for it; 0 if not charged
+    bool whole = false;       // the source was smaller than size, so this is all of it
+    critical_section sync;    // GDI+ locks a bitmap's bits for one caller at a time - held while resampling from it
+
+    ~artwork_level();  // after thumbnail_cache
+};
+
 // Thumbnail cache entry with memory tracking
 
 struct thumbnail_data {
@@ -878,6 +1013,11 @@ struct thumbnail_data {
 
     size_t memory_size;
 
+    // v10.0.52: The cover as decoded (see level_for()); bitmap is resampled from it
+    // whenever the cell size changes within the level. Possibly shared with other
+    // thumbnails, so memory_size leaves it out: the cache counts levels by themselves.
+    std::shared_ptr<artwork_level> level;
+
     
 
     thumbnail_data() : bitmap(nullptr), last_access(GetTickCount64()), loading(false), cached_size(0), memory_size(0) {}
@@ -894,35 +1034,55 @@ struct thumbnail_data {
 
     void clear() {
 
-        if (bitmap) {
+        if (bitmap || level) {
             // Prefer explicit shutdown signal
             if (shutdown_protection::is_shutting_down()) {
-                bitmap = nullptr; memory_size = 0; return;
+                bitmap = nullptr; level.reset(); memory_size = 0; return;
             }
             delete bitmap;
             bitmap = nullptr;
+            level.reset();
             memory_size = 0;
         }
     }
 
     
 
-    void set_bitmap(Gdiplus::Bitmap* bmp, int size) {
+    // v10.0.52: lvl is the decoded cover bmp was resampled from, if any
+    void set_bitmap(Gdiplus::Bitmap* bmp, int size, std::shared_ptr<artwork_level> lvl = nullptr) {
 
         clear();
 
         bitmap = bmp;
 
+        level = std::move(lvl);
+
         cached_size = size;
 
         last_access = GetTickCount64();
 
-        if (bmp) {
+        update_memory_size();
 
-            memory_size = bmp->GetWidth() * bmp->GetHeight() * 4;
+    }
 
-        }
+    // v10.0.52: Size a cover is decoded at for cells of size: the next power of two
+    // at or above twice the cell, from 128 up to create_thumbnail()'s limit of 1024.
+    // The headroom lets the cell grow by up to 2x (a column step) and still be
+    // resampled from the same decode.
+    static int level_for(int size) {
+        int decoded = 128;
+        while (decoded < 2 * size && decoded < 1024) decoded *= 2;
+        return decoded;
+    }
+
+    // The level can be resampled down to size, or is as large as the cover gets
+    bool level_covers(int size) const {
+        return level && (level->whole || std::min(size, 1024) <= level->size);
+    }
 
+    void update_memory_size() {
+        memory_size = 0;
+        if (bitmap) memory_size += (size_t)bitmap->GetWidth() * bitmap->GetHeight() * 4;
     }
 
     
@@ -948,6 +1108,17 @@ private:
     static int viewport_last;
     static std::atomic<bool> shutdown_in_progress;  // v10.0.9: F9FCh crash fix
     static critical_section cache_sync;
+    // v10.0.52: Decoded artwork by art source + size bucket (see art_key()), so a
+    // rebuilt item showing the same cover re-attaches the existing bitmap instead of
+    // decoding it again. Weak - entries go away with their thumbnail.
+    static std::unordered_map<std::string, std::weak_ptr<thumbnail_data>> by_art;
+    // v10.0.52: Decoded levels by content hash and level size (level_key()), so artwork
+    // with the same bytes - compilations, box sets split into disc folders, one artist
+    // image for many albums - is decoded once and shared. Weak - a level lives as long
+    // as a thumbnail holds it.
+    static std::unordered_map<uint64_t, std::weak_ptr<artwork_level>> by_content;
+    static std::atomic<uint64_t> content_lookups;
+    static std::atomic<uint64_t> content_hits;
     
 
     static size_t get_available_memory() {
@@ -974,6 +1145,104 @@ public:
             lru.erase(node); idx.erase(it);
         }
     }
+    static std::string art_key(const std::string& art_source, int size) {
+        return art_source + "|" + std::to_string((size + 31) / 32);
+    }
+
+    static void remember_art(const std::string& key, const std::shared_ptr<thumbnail_data>& sp) {
+        if (!sp || !sp->bitmap || shutdown_in_progress.load()) return;
+        insync(cache_sync);
+        by_art[key] = sp;
+        if (by_art.size() > 2 * lru.size() + 256) {
+            for (auto it = by_art.begin(); it != by_art.end();) {
+                auto known = it->second.lock();
+                if (!known || !known->bitmap) it = by_art.erase(it);
+                else ++it;
+            }
+        }
+    }
+
+    // Thumbnail that already holds a bitmap for the key, or null
+    static std::shared_ptr<thumbnail_data> find_art(const std::string& key) {
+        insync(cache_sync);
+        auto it = by_art.find(key);
+        if (it == by_art.end()) return nullptr;
+        auto known = it->second.lock();
+        if (!known || !known->bitmap) {
+            by_art.erase(it);
+            return nullptr;
+        }
+        return known;
+    }
+
+    static void forget_art() {
+        insync(cache_sync);
+        by_art.clear();
+    }
+
+    static uint64_t level_key(uint64_t content, int level_size) {
+        return content ^ (uint64_t)level_size * 0x9E3779B97F4A7C15ULL;
+    }
+
+    static bool same_content(const artwork_level& level, uint64_t content, size_t encoded_size, int level_size) {
+        return level.content == content && level.encoded_size == encoded_size && level.size == level_size;
+    }
+
+    // v10.0.52: Level already decoded from artwork with these bytes, or null
+    static std::shared_ptr<artwork_level> find_level(uint64_t content, size_t encoded_size, int level_size) {
+        insync(cache_sync);
+        content_lookups++;
+        auto it = by_content.find(level_key(content, level_size));
+        if (it == by_content.end()) return nullptr;
+        auto known = it->second.lock();
+        if (!known) {
+            by_content.erase(it);
+            return nullptr;
+        }
+        if (!same_content(*known, content, encoded_size, level_size)) return nullptr;
+        content_hits++;
+        return known;
+    }
+
+    // v10.0.52: Registers a freshly decoded level and returns the one to use: an equal
+    // level another load registered meanwhile wins, so the artwork is still held once.
+    // The registered level is charged to total_memory until it is destroyed.
+    static std::shared_ptr<artwork_level> remember_level(const std::shared_ptr<artwork_level>& level) {
+        if (!level || shutdown_in_progress.load()) return level;
+        insync(cache_sync);
+        std::weak_ptr<artwork_level>& slot = by_content[level_key(level->content, level->size)];
+        auto known = slot.lock();
+        if (known && same_content(*known, level->content, level->encoded_size, level->size)) return known;
+        slot = level;
+        if (level->bitmap && level->memory_size == 0) {
+            level->memory_size = (size_t)level->bitmap->GetWidth() * level->bitmap->GetHeight() * 4;
+            total_memory += level->memory_size;
+        }
+        if (by_content.size() > 2 * lru.size() + 256) {
+            for (auto it = by_content.begin(); it != by_content.end();) {
+                if (it->second.expired()) it = by_content.erase(it);
+                else ++it;
+            }
+        }
+        return level;
+    }
+
+    // v10.0.52: Called as a charged level goes away
+    static void release_level(size_t memory_size) {
+        if (memory_size == 0 || shutdown_in_progress.load()) return;
+        insync(cache_sync);
+        total_memory -= std::min(total_memory, memory_size);
+    }
+
+    // v10.0.52: Printed at shutdown with the loader statistics
+    static void print_stats() {
+        const uint64_t lookups = content_lookups.load();
+        if (lookups == 0) return;
+        const uint64_t hits = content_hits.load();
+        console::printf("[Album Art Grid v10.0.52] Artwork by content: %u of %u levels shared instead of decoded (%u%% hit ratio)",
+            (unsigned)hits, (unsigned)lookups, (unsigned)(hits * 100 / lookups));
+    }
+
     static void update_viewport(int first, int last) {
 
         viewport_first = first;
@@ -1040,7 +1309,7 @@ public:
 
         insync(cache_sync);
         for (auto& sp : lru) { if (sp && sp->bitmap) { try { sp->clear(); } catch(...) {} } }
-        lru.clear(); idx.clear();
+        lru.clear(); idx.clear(); by_art.clear(); by_content.clear();
         total_memory = 0;
     }
     
@@ -1057,6 +1326,10 @@ public:
 
     static size_t get_cache_limit() { return max_cache_size; }
 
+    static uint64_t get_content_lookups() { return content_lookups.load(); }
+
+    static uint64_t get_content_hits() { return content_hits.load(); }
+
 };
 
 
@@ -1076,6 +1349,15 @@ int thumbnail_cache::viewport_last = 0;
 std::atomic<bool> thumbnail_cache::shutdown_in_progress = false;  // v10.0.9: F9FCh fix
 
 critical_section thumbnail_cache::cache_sync;
+std::unordered_map<std::string, std::weak_ptr<thumbnail_data>> thumbnail_cache::by_art;
+std::unordered_map<uint64_t, std::weak_ptr<artwork_level>> thumbnail_cache::by_content;
+std::atomic<uint64_t> thumbnail_cache::content_lookups{0};
+std::atomic<uint64_t> thumbnail_cache::content_hits{0};
+
+artwork_level::~artwork_level() {
+    thumbnail_cache::release_level(memory_size);
+    if (bitmap && !shutdown_protection::is_shutting_down()) delete bitmap;
+}
 
 
 
@@ -1083,15 +1365,17 @@ critical_section thumbnail_cache::cache_sync;
 
 // Album/folder data structure
 
+// v10.0.52: Text fields are views into the model's string pool (track_snapshot::strings),
+// interned once per distinct value and freed with the model
 struct grid_item {
 
-    pfc::string8 display_name;  // Using pfc::string8 for proper UTF-8 handling
+    albumart_grid::pooled_string display_name;
 
-    pfc::string8 folder_name;   // v10.0.4: Store actual folder name separately
+    albumart_grid::pooled_string folder_name;   // v10.0.4: Store actual folder name separately
 
-    pfc::string8 sort_key;
+    albumart_grid::pooled_string sort_key;
 
-    pfc::string8 path;
+    albumart_grid::pooled_string path;
 
     metadb_handle_list tracks;
 
@@ -1110,13 +1394,13 @@ struct grid_item {
 
     // Additional fields for sorting
 
-    pfc::string8 artist;
+    albumart_grid::pooled_string artist;
 
-    pfc::string8 album;
+    albumart_grid::pooled_string album;
 
-    pfc::string8 genre;
+    albumart_grid::pooled_string genre;
 
-    pfc::string8 year;
+    albumart_grid::pooled_string year;
 
     int rating;
 
@@ -1126,6 +1410,13 @@ struct grid_item {
 
     mutable int cached_label_format = -1;
     mutable std::wstring cached_label_w;
+    // v10.0.52: Binary sort key for the sort_spec with id cached_order_id (see
+    // build_order_key()); reset whenever the item is refolded
+    mutable uint32_t cached_order_id = 0;
+    mutable std::string cached_order_key;
+    // v10.0.52: Entry in the panel's search index, current only while the index
+    // names this item as its owner (see update_search_index()); reset on refold
+    mutable uint32_t search_id = albumart_grid::search_index::no_entry;
 
     
 
@@ -1137,7 +1428,7 @@ struct grid_item {
 
             case grid_config::LABEL_ALBUM_ONLY:
 
-                return album.is_empty() ? display_name : album;
+                return album.is_empty() ? display_name.c_str() : album.c_str();
 
             
 
@@ -1145,7 +1436,7 @@ struct grid_item {
 
                 // v10.0.4: Added artist only option
 
-                return artist.is_empty() ? display_name : artist;
+                return artist.is_empty() ? display_name.c_str() : artist.c_str();
 
             
 
@@ -1155,17 +1446,17 @@ struct grid_item {
 
                     pfc::string8 result;
 
-                    result << artist << " - " << album;
+                    result << artist.c_str() << " - " << album.c_str();
 
                     return result;
 
                 } else if (!album.is_empty()) {
 
-                    return album;
+                    return album.c_str();
 
                 } else {
 
-                    return display_name;
+                    return display_name.c_str();
 
                 }
 
@@ -1175,13 +1466,13 @@ struct grid_item {
 
                 // v10.0.4: Return actual folder name
 
-                return folder_name.is_empty() ? display_name : folder_name;
+                return folder_name.is_empty() ? display_name.c_str() : folder_name.c_str();
 
             
 
             default:
 
-                return display_name;
+                return display_name.c_str();
 
         }
 
@@ -1224,134 +1515,78 @@ static int parse_first_int_anywhere(const char* value) {
     return out;
 }
 
-static int infer_disc_number_from_path(const char* path);
-
+// v10.0.52: Path parsing lives in src/core/path_analysis.h; the model goes through
+// track_snapshot's per-directory cache instead, these are for one-off paths.
 static bool try_get_album_root_folder_from_file_path(const char* file_path, pfc::string8& out_folder_path, pfc::string8& out_folder_name) {
     out_folder_path.reset();
     out_folder_name.reset();
-
     if (!file_path || !file_path[0]) return false;
-    if (infer_disc_number_from_path(file_path) <= 0) return false;
-
-    const char* file_slash = strrchr(file_path, '\\');
-    if (!file_slash) file_slash = strrchr(file_path, '/');
-    if (!file_slash || file_slash == file_path) return false;
+    const albumart_grid::directory_info dir = albumart_grid::analyze_directory(file_path, albumart_grid::directory_prefix_length(file_path));
+    if (!dir.has_album_root()) return false;
+    out_folder_name.set_string(dir.album_root_name.data(), dir.album_root_name.size());
+    out_folder_path.set_string(dir.album_root_path.data(), dir.album_root_path.size());
+    return true;
+}
 
-    // file_path: ...\Album\CD1\track.ext
-    // file_slash points to slash before track.ext, so disc folder name is the last directory segment
-    const char* disc_slash = file_slash - 1;
-    while (disc_slash > file_path && *disc_slash != '\\' && *disc_slash != '/') --disc_slash;
-    if (disc_slash <= file_path) return false;
+static int infer_disc_number_from_path(const char* path) {
+    if (!path || !path[0]) return 0;
+    return albumart_grid::analyze_directory(path, albumart_grid::directory_prefix_length(path)).disc;
+}
 
-    const char* album_slash = disc_slash - 1;
-    while (album_slash > file_path && *album_slash != '\\' && *album_slash != '/') --album_slash;
-    const char* album_name_start = (*album_slash == '\\' || *album_slash == '/') ? (album_slash + 1) : file_path;
-    const char* album_name_end = disc_slash;
+// v10.0.52: Disc number from tags (DISCNUMBER/DISC/DISC NO). info may be null when
+// the metadb has no info.
+static int get_disc_number_from_tags(const file_info* info) {
+    if (!info) return 0;
+    const char* disc_value = info->meta_get("DISCNUMBER", 0);
+    if (!disc_value || !disc_value[0]) disc_value = info->meta_get("DISC", 0);
+    if (!disc_value || !disc_value[0]) disc_value = info->meta_get("DISC NO", 0);
+    return parse_first_int_anywhere(disc_value);
+}
 
-    if (album_name_end <= album_name_start) return false;
+// Tags first, falling back to a CD1/Disc 2 style parent folder
+static int get_disc_number_from_info(const file_info* info, const char* path) {
+    int disc = get_disc_number_from_tags(info);
+    if (disc <= 0) disc = infer_disc_number_from_path(path);
+    return disc;
+}
 
-    out_folder_name.set_string(album_name_start, album_name_end - album_name_start);
-    out_folder_path.set_string(file_path, disc_slash - file_path);
-    return !out_folder_name.is_empty() && !out_folder_path.is_empty();
+static int get_track_number_from_info(const file_info* info) {
+    if (!info) return 0;
+    const char* track_value = info->meta_get("TRACKNUMBER", 0);
+    if (!track_value || !track_value[0]) track_value = info->meta_get("TRACK", 0);
+    return parse_first_int_anywhere(track_value);
 }
 
 static int get_disc_number_for_handle(metadb_handle_ptr handle) {
     if (!handle.is_valid()) return 0;
 
-    int disc = 0;
     try {
-        file_info_impl info;
-        if (handle->get_info(info)) {
-            const char* disc_value = info.meta_get("DISCNUMBER", 0);
-            if (!disc_value || !disc_value[0]) disc_value = info.meta_get("DISC", 0);
-            if (!disc_value || !disc_value[0]) disc_value = info.meta_get("DISC NO", 0);
-            disc = parse_first_int_anywhere(disc_value);
-        }
+        metadb_info_container::ptr info_ref;
+        const file_info* info = handle->get_info_ref(info_ref) ? &info_ref->info() : nullptr;
+        return get_disc_number_from_info(info, handle->get_path());
     } catch (...) {
-        disc = 0;
-    }
-
-    if (disc <= 0) {
-        try {
-            disc = infer_disc_number_from_path(handle->get_path());
-        } catch (...) {
-            disc = 0;
-        }
+        return 0;
     }
-
-    return disc;
 }
 
 static int get_track_number_for_handle(metadb_handle_ptr handle) {
     if (!handle.is_valid()) return 0;
 
-    int track = 0;
     try {
-        file_info_impl info;
-        if (handle->get_info(info)) {
-            const char* track_value = info.meta_get("TRACKNUMBER", 0);
-            if (!track_value || !track_value[0]) track_value = info.meta_get("TRACK", 0);
-            track = parse_first_int_anywhere(track_value);
-        }
+        metadb_info_container::ptr info_ref;
+        if (handle->get_info_ref(info_ref)) return get_track_number_from_info(&info_ref->info());
     } catch (...) {
-        track = 0;
     }
 
-    return track;
+    return 0;
 }
 
-static bool is_better_representative_track(metadb_handle_ptr candidate, metadb_handle_ptr current) {
-    if (!candidate.is_valid()) return false;
-    if (!current.is_valid()) return true;
-
-    int cand_disc = get_disc_number_for_handle(candidate);
-    int curr_disc = get_disc_number_for_handle(current);
-
+// Lower disc wins (tracks with a disc number beat those without), then path order
+static bool is_better_representative(int cand_disc, const char* cand_path, int curr_disc, const char* curr_path) {
     if (cand_disc > 0 && curr_disc > 0 && cand_disc != curr_disc) return cand_disc < curr_disc;
     if (cand_disc > 0 && curr_disc <= 0) return true;
     if (cand_disc <= 0 && curr_disc > 0) return false;
-
-    try {
-        pfc::string8 cand_path = candidate->get_path();
-        pfc::string8 curr_path = current->get_path();
-        return pfc::stricmp_ascii(cand_path.c_str(), curr_path.c_str()) < 0;
-    } catch (...) {
-        return false;
-    }
-}
-
-static void update_representative_track(grid_item& item, metadb_handle_ptr handle) {
-    if (is_better_representative_track(handle, item.representative_track)) {
-        item.representative_track = handle;
-    }
-}
-
-static int infer_disc_number_from_path(const char* path) {
-    if (!path || !path[0]) return 0;
-
-    const char* last_slash = strrchr(path, '\\');
-    if (!last_slash) last_slash = strrchr(path, '/');
-    if (!last_slash || last_slash == path) return 0;
-
-    const char* start = path;
-    const char* prev_slash = last_slash - 1;
-    while (prev_slash > start && *prev_slash != '\\' && *prev_slash != '/') --prev_slash;
-    if (*prev_slash == '\\' || *prev_slash == '/') ++prev_slash;
-    if (prev_slash >= last_slash) return 0;
-
-    std::string folder(prev_slash, last_slash);
-    std::string upper;
-    upper.reserve(folder.size());
-    for (unsigned char c : folder) upper.push_back((char)std::toupper(c));
-
-    // Heuristic: only treat as disc folder if it contains a likely marker.
-    if (upper.find("DISC") == std::string::npos &&
-        upper.find("DISK") == std::string::npos &&
-        upper.find("CD") == std::string::npos) {
-        return 0;
-    }
-
-    return parse_first_int_anywhere(upper.c_str());
+    return pfc::stricmp_ascii(cand_path ? cand_path : "", curr_path ? curr_path : "") < 0;
 }
 
 static uint8_t popcount_u32(uint32_t v) {
@@ -1363,28 +1598,7 @@ static uint8_t popcount_u32(uint32_t v) {
     return c;
 }
 
-static void add_disc_to_item(grid_item& item, metadb_handle_ptr handle) {
-    int disc = 0;
-    try {
-        file_info_impl info;
-        if (handle->get_info(info)) {
-            const char* disc_value = info.meta_get("DISCNUMBER", 0);
-            if (!disc_value || !disc_value[0]) disc_value = info.meta_get("DISC", 0);
-            if (!disc_value || !disc_value[0]) disc_value = info.meta_get("DISC NO", 0);
-            disc = parse_first_int_anywhere(disc_value);
-        }
-    } catch (...) {
-        // ignore
-    }
-
-    if (disc <= 0) {
-        try {
-            disc = infer_disc_number_from_path(handle->get_path());
-        } catch (...) {
-            disc = 0;
-        }
-    }
-
+static void add_disc_to_item(grid_item& item, int disc) {
     if (disc > 0 && disc <= 32) {
         item.disc_mask |= (1u << (uint32_t)(disc - 1));
     }
@@ -1644,62 +1858,1266 @@ static uint32_t extract_release_date_from_info(const file_info& info) {
 
 
 
-class album_grid_instance : public ui_element_instance,
-
-                          public playlist_callback_single,
+// v10.0.52: Columnar per-track metadata snapshot. It is filled in the same parallel
+// pass that computes group keys, with a single get_info_ref() per track; grouping,
+// item building, track sorting and now-playing lookup read the columns instead of
+// querying the metadb again. String columns point into the info references held in
+// `infos` (and paths into `handles`), so nothing is copied and the pointers stay
+// valid for the lifetime of the snapshot.
+struct track_snapshot {
+    metadb_handle_list handles;
+    std::vector<metadb_info_container::ptr> infos;
+    std::vector<const char*> path, artist, album, genre, date, title;
+    std::vector<int> disc, track_number, rating;
+    std::vector<uint32_t> release_date_key;
+    std::vector<t_filetimestamp> timestamp;
+    std::vector<t_filesize> size;
+    std::vector<grid_item*> owner;  // group the track was placed in, null for dead rows
+    // v10.0.52: Album root, folder name and folder disc number of each row's
+    // directory, parsed once per directory and shared by all of its rows
+    std::vector<const albumart_grid::directory_info*> directory;
+    std::shared_ptr<albumart_grid::directory_cache> directories = std::make_shared<albumart_grid::directory_cache>();
+    // v10.0.52: Text of the items built from this snapshot. Lives and dies with the
+    // model, so the items must go before the snapshot is cleared or replaced. Copies
+    // of the model made for other panels (clone_model()) share it.
+    std::shared_ptr<albumart_grid::string_pool> strings = std::make_shared<albumart_grid::string_pool>();
 
-                          public validated_object {
+    void clear() {
+        handles.remove_all();
+        resize_columns();
+        strings = std::make_shared<albumart_grid::string_pool>();
+        directories = std::make_shared<albumart_grid::directory_cache>();
+    }
+
+    size_t get_count() const { return handles.get_count(); }
+    size_t get_dead_count() const { return dead_rows; }
+
+    // Call after filling `handles`
+    void resize_columns() {
+        const size_t n = get_count();
+        for_each_column([n](auto& column) {
+            column.clear();
+            column.resize(n);
+        });
+        dead_rows = 0;
+        row_index.clear();
+        row_index_ready = false;
+    }
+
+    // Appends rows for the given tracks (not loaded yet) and returns the first new row
+    size_t append(metadb_handle_list_cref items) {
+        const size_t first = get_count();
+        handles.add_items(items);
+        const size_t n = get_count();
+        for_each_column([n](auto& column) { column.resize(n); });
+        return first;
+    }
+
+    // Makes rows [first, end) findable through row_of() once their owner is set
+    void index_rows(size_t first, size_t end) {
+        if (!row_index_ready) return;
+        for (size_t i = first; i < end; i++) {
+            if (owner[i]) row_index.emplace(handles[i].get_ptr(), (uint32_t)i);
+        }
+    }
+
+    // Drops a track that left the view; the row stays allocated until compact()
+    void kill_row(size_t row) {
+        if (!owner[row]) return;
+        if (row_index_ready) {
+            auto found = row_index.find(handles[row].get_ptr());
+            if (found != row_index.end() && found->second == row) row_index.erase(found);
+        }
+        owner[row] = nullptr;
+        infos[row].release();
+        dead_rows++;
+    }
+
+    // Rewrites the table without dead rows. Row numbers change; returns the old row
+    // number of every kept row.
+    std::vector<uint32_t> compact() {
+        std::vector<uint32_t> keep;
+        keep.reserve(get_count());
+        for (size_t i = 0; i < get_count(); i++) {
+            if (owner[i]) keep.push_back((uint32_t)i);
+        }
+        metadb_handle_list live;
+        live.prealloc(keep.size());
+        for (uint32_t row : keep) live.add_item(handles[row]);
+        for_each_column([&keep](auto& column) {
+            typename std::remove_reference<decltype(column)>::type packed;
+            packed.reserve(keep.size());
+            for (uint32_t row : keep) packed.push_back(column[row]);
+            column.swap(packed);
+        });
+        handles = live;
+        dead_rows = 0;
+        row_index.clear();
+        row_index_ready = false;
+        return keep;
+    }
+
+    const file_info* info_at(size_t row) const {
+        return infos[row].is_valid() ? &infos[row]->info() : nullptr;
+    }
+
+    const albumart_grid::directory_info& directory_at(size_t row) const {
+        static const albumart_grid::directory_info none;
+        return directory[row] ? *directory[row] : none;
+    }
+
+    // Reads every column of one row and returns its info (nullptr if the metadb has
+    // none). Distinct rows may be loaded from different threads concurrently.
+    const file_info* load_row(size_t row) {
+        const metadb_handle_ptr& handle = handles[row];
+        path[row] = handle->get_path();
+        directory[row] = &directories->lookup(path[row]);
+        const file_info* info = nullptr;
+        if (handle->get_info_ref(infos[row])) {
+            info = &infos[row]->info();
+            const t_filestats& stats = infos[row]->stats();
+            timestamp[row] = stats.m_timestamp;
+            size[row] = stats.m_size;
+            const char* value = info->meta_get("ARTIST", 0);
+            if (!value || !value[0]) value = info->meta_get("ALBUM ARTIST", 0);
+            artist[row] = value;
+            album[row] = info->meta_get("ALBUM", 0);
+            genre[row] = info->meta_get("GENRE", 0);
+            value = info->meta_get("DATE", 0);
+            if (!value || !value[0]) value = info->meta_get("YEAR", 0);
+            date[row] = value;
+            title[row] = info->meta_get("TITLE", 0);
+            value = info->meta_get("RATING", 0);
+            rating[row] = value ? atoi(value) : 0;
+            release_date_key[row] = extract_release_date_from_info(*info);
+            track_number[row] = get_track_number_from_info(info);
+        } else {
+            infos[row].release();
+            t_filestats stats = handle->get_filestats();
+            timestamp[row] = stats.m_timestamp;
+            size[row] = stats.m_size;
+        }
+        const int tagged_disc = get_disc_number_from_tags(info);
+        disc[row] = tagged_disc > 0 ? tagged_disc : directory[row]->disc;
+        return info;
+    }
+
+    // Live row of a handle (first occurrence), or -1. The index is built on first
+    // use; UI thread only.
+    int row_of(const metadb_handle_ptr& handle) const {
+        if (!handle.is_valid()) return -1;
+        if (!row_index_ready) {
+            row_index.reserve(get_count());
+            for (size_t i = 0; i < get_count(); i++) {
+                if (owner[i]) row_index.emplace(handles[i].get_ptr(), (uint32_t)i);
+            }
+            row_index_ready = true;
+        }
+        auto found = row_index.find(handle.get_ptr());
+        return found != row_index.end() ? (int)found->second : -1;
+    }
 
 private:
+    template <typename Fn>
+    void for_each_column(Fn&& fn) {
+        fn(infos); fn(path); fn(artist); fn(album); fn(genre); fn(date); fn(title);
+        fn(disc); fn(track_number); fn(rating); fn(release_date_key);
+        fn(timestamp); fn(size); fn(owner); fn(directory);
+    }
 
-    // CRITICAL FIX: Manual reference counting
+    size_t dead_rows = 0;
+    mutable std::unordered_map<const metadb_handle*, uint32_t> row_index;
+    mutable bool row_index_ready = false;
+};
 
-    volatile long m_refcount;
+// v10.0.52: Copies a model for another panel. Items get their own thumbnail state
+// (attach_known_artwork() finds decoded covers by art source), the snapshot its own
+// columns with owners pointing at the copies; text and directory analysis are shared.
+static void clone_model(const std::vector<std::unique_ptr<grid_item>>& items, const track_snapshot& snapshot,
+                        std::vector<std::unique_ptr<grid_item>>& out_items, track_snapshot& out_snapshot) {
+    std::unordered_map<const grid_item*, grid_item*> copies;
+    copies.reserve(items.size());
+    out_items.clear();
+    out_items.reserve(items.size());
+    for (const auto& item : items) {
+        auto copy = std::make_unique<grid_item>(*item);
+        copy->thumbnail = std::make_shared<thumbnail_data>();
+        // The receiving panel's search index knows entries by owner pointer, and a
+        // freed item's address may come back here with a matching id
+        copy->search_id = albumart_grid::search_index::no_entry;
+        copies.emplace(item.get(), copy.get());
+        out_items.push_back(std::move(copy));
+    }
+    out_snapshot = snapshot;
+    for (grid_item*& owner : out_snapshot.owner) {
+        if (owner) owner = copies[owner];
+    }
+}
 
-    
+// v10.0.52: Group-key extractors, one per grid_config::group_mode. Each one fills
+// the caller's key/display buffers for a single track from the info and directory
+// analysis loaded into the snapshot (info is null when the metadb has none); titleformat scripts are compiled once
+// in the constructor, i.e. once per refresh. group_items_with<> is
+// instantiated per extractor, so the per-track loop carries no mode switch, and
+// every grouping worker runs on its own copy (scratch buffers are never shared).
+
+struct group_key_folder {
+    void operator()(const metadb_handle_ptr& handle, const file_info* info, const albumart_grid::directory_info& directory,
+                    pfc::string8& key, pfc::string8& display_name) {
+        // Group by folder - but check metadata first for multi-disc albums
+        bool got_from_metadata = false;
+        // IMPORTANT: Wrap in try-catch to handle problematic paths
+        try {
+            if (info) {
+                const char* album = info->meta_get("ALBUM", 0);
+                const char* album_artist = info->meta_get("ALBUM ARTIST", 0);
+                if (!album_artist || !album_artist[0]) {
+                    album_artist = info->meta_get("ARTIST", 0);
+                }
+                if (album && album[0]) {
+                    if (album_artist && album_artist[0]) {
+                        key << album_artist << " - " << album;
+                    } else {
+                        key = album;
+                    }
+                    display_name = album;
+                    got_from_metadata = true;
+                }
+            }
+        } catch (...) {
+            console::print("[Album Art Grid v10.0.4] Warning: Failed to get metadata for an item, using folder name");
+        }
+        // Fall back to folder name if no metadata or if metadata extraction failed
+        if (!got_from_metadata) {
+            try {
+                const std::string_view folder = directory.has_album_root() ? directory.album_root_name : directory.folder_name;
+                key.set_string(folder.data(), folder.size());
+                display_name = key;
+            } catch (...) {
+                console::print("[Album Art Grid v10.0.4] Warning: Failed to process path for an item");
+                key = "Unknown";
+                display_name = key;
+            }
+        }
+        if (key.is_empty()) {
+            key = "Unknown Folder";
+            display_name = key;
+        }
+    }
+};
 
-    HWND m_hwnd;
+// GROUP_BY_ALBUM / GROUP_BY_ARTIST_ALBUM: "[%album artist%]", "[%artist%]" and
+// "[%album%]" run as three precompiled scripts against one info reference, which
+// replaces compiling "[%album artist%]|[%artist%]|[%album%]" and splitting on '|'
+// for every track.
+template <bool artist_album>
+struct group_key_album {
+    titleformat_object::ptr album_artist_script, artist_script, album_script;
+    pfc::string8 album_artist, artist, album;
+
+    group_key_album() {
+        auto compiler = titleformat_compiler::get();
+        compiler->compile_safe(album_artist_script, "[%album artist%]");
+        compiler->compile_safe(artist_script, "[%artist%]");
+        compiler->compile_safe(album_script, "[%album%]");
+    }
+
+    void operator()(const metadb_handle_ptr& handle, const file_info* info, const albumart_grid::directory_info&,
+                    pfc::string8& key, pfc::string8& display_name) {
+        album_artist.reset();
+        artist.reset();
+        album.reset();
+        if (info) {
+            const playable_location& location = handle->get_location();
+            album_artist_script->run_simple(location, info, album_artist);
+            artist_script->run_simple(location, info, artist);
+            album_script->run_simple(location, info, album);
+        }
+        // Use album artist if available, otherwise use artist
+        const pfc::string8& primary_artist = !album_artist.is_empty() ? album_artist : artist;
+        if (!artist_album) {
+            if (!album.is_empty()) {
+                if (!primary_artist.is_empty()) {
+                    key << primary_artist << " - " << album;
+                } else {
+                    key = album;
+                }
+                display_name = album;
+            } else {
+                key = "Unknown Album";
+                display_name = key;
+            }
+        } else {
+            if (!primary_artist.is_empty() && !album.is_empty()) {
+                key << primary_artist << " - " << album;
+            } else if (!primary_artist.is_empty()) {
+                key = primary_artist;
+            } else if (!album.is_empty()) {
+                key = album;
+            } else {
+                key = "Unknown";
+            }
+            display_name = key;
+        }
+    }
+};
 
-    HWND m_parent;
+// Single-tag groupings: the first non-empty field of Traits::fields is turned into
+// the key by Traits::make_key(); an empty key falls back to Traits::unknown.
+template <typename Traits>
+struct group_key_meta {
+    void operator()(const metadb_handle_ptr& handle, const file_info* info, const albumart_grid::directory_info&,
+                    pfc::string8& key, pfc::string8& display_name) {
+        if (info) {
+            const char* value = nullptr;
+            for (const char* field : Traits::fields) {
+                value = info->meta_get(field, 0);
+                if (value && value[0]) break;
+            }
+            if (value && value[0]) Traits::make_key(value, key);
+        }
+        if (key.is_empty()) key = Traits::unknown;
+        display_name = key;
+    }
+};
 
-    HWND m_tooltip;  // Tooltip window
-    HWND m_search_box;  // Search/filter text box
-    // Reusable back buffer for painting
-    HDC m_memdc = NULL;
-    HBITMAP m_membmp = NULL;
-    HBITMAP m_oldbmp = NULL;
-    int m_bufW = 0, m_bufH = 0;
-    HFONT m_placeholder_font = NULL;
-    int m_placeholder_font_size = 0;
-    std::vector<std::unique_ptr<grid_item>> m_items;
+struct plain_meta_key {
+    static void make_key(const char* value, pfc::string8& key) { key = value; }
+};
+struct artist_key_traits : plain_meta_key {
+    static constexpr const char* fields[] = { "ARTIST", "ALBUM ARTIST" };
+    static constexpr const char* unknown = "Unknown Artist";
+};
+struct genre_key_traits : plain_meta_key {
+    static constexpr const char* fields[] = { "GENRE" };
+    static constexpr const char* unknown = "Unknown Genre";
+};
+struct year_key_traits {
+    static constexpr const char* fields[] = { "DATE", "YEAR" };
+    static constexpr const char* unknown = "Unknown Year";
+    // Extract year from date (might be YYYY-MM-DD or just YYYY)
+    static void make_key(const char* value, pfc::string8& key) {
+        if (strlen(value) >= 4) key.set_string(value, 4);
+    }
+};
+struct label_key_traits : plain_meta_key {
+    static constexpr const char* fields[] = { "LABEL", "PUBLISHER" };
+    static constexpr const char* unknown = "Unknown Label";
+};
+struct composer_key_traits : plain_meta_key {
+    static constexpr const char* fields[] = { "COMPOSER" };
+    static constexpr const char* unknown = "Unknown Composer";
+};
+struct performer_key_traits : plain_meta_key {
+    static constexpr const char* fields[] = { "PERFORMER", "ARTIST" };
+    static constexpr const char* unknown = "Unknown Performer";
+};
+struct album_artist_key_traits : plain_meta_key {
+    static constexpr const char* fields[] = { "ALBUM ARTIST", "ALBUMARTIST", "ARTIST" };
+    static constexpr const char* unknown = "Unknown Album Artist";
+};
+struct comment_key_traits {
+    static constexpr const char* fields[] = { "COMMENT" };
+    static constexpr const char* unknown = "No Comment";
+    // Truncate long comments for grouping
+    static void make_key(const char* value, pfc::string8& key) {
+        if (strlen(value) > 50) {
+            key.set_string(value, 50);
+            key << "...";
+        } else {
+            key = value;
+        }
+    }
+};
+struct rating_key_traits {
+    static constexpr const char* fields[] = { "RATING" };
+    static constexpr const char* unknown = "Unrated";
+    static void make_key(const char* value, pfc::string8& key) {
+        int rating_val = atoi(value);
+        if (rating_val > 0) key << rating_val << " Stars";
+    }
+};
 
-    std::vector<int> m_filtered_indices;  // Indices of filtered items
+struct group_key_directory {
+    void operator()(const metadb_handle_ptr& handle, const file_info* info, const albumart_grid::directory_info& directory,
+                    pfc::string8& key, pfc::string8& display_name) {
+        // Group by parent directory name (not full path); a top-level folder
+        // such as the drive counts as the root
+        if (directory.has_album_root()) {
+            key.set_string(directory.album_root_name.data(), directory.album_root_name.size());
+        } else if (directory.folder_has_parent) {
+            key.set_string(directory.folder_name.data(), directory.folder_name.size());
+        }
+        if (key.is_empty()) key = "Root Directory";
+        display_name = key;
+    }
+};
 
-    pfc::string8 m_search_text;  // Current search filter
+// v10.0.52: (Re)computes everything a grid item derives from its tracks, using
+// snapshot columns only. rows are in playlist/library order; the first one supplies
+// folder and sort metadata, and every row is folded into discs, dates and sizes,
+// exactly as the old single-pass loop did. Safe on a grouping worker as long as no
+// other thread touches the same rows.
+static void fold_group_rows(grid_item& item, track_snapshot& snapshot, const std::vector<uint32_t>& rows) {
+    albumart_grid::string_pool& strings = *snapshot.strings;
+    const uint32_t first = rows[0];
+    item.tracks.remove_all();
+    item.tracks.prealloc(rows.size());
+    item.disc_mask = 0;
+    item.release_date_key = 0;
+    item.year = albumart_grid::pooled_string();
+
+    // v10.0.4: Always extract and store the actual folder name
+    const albumart_grid::directory_info& directory = snapshot.directory_at(first);
+    if (directory.has_album_root()) {
+        // Multi-disc folder layouts (CD1/CD2): treat the album root as the folder identity
+        item.folder_name = strings.intern(directory.album_root_name);
+        item.path = strings.intern(directory.album_root_path);
+    } else {
+        item.folder_name = directory.folder_name.empty() ? strings.intern("Root") : strings.intern(directory.folder_name);
+        item.path = strings.intern(snapshot.path[first]);
+    }
+
+    // Metadata for sorting comes from the first track (its size is counted
+    // again in the loop below, as before)
+    item.newest_date = snapshot.timestamp[first];
+    item.total_size = snapshot.size[first];
+    item.artist = strings.intern(snapshot.artist[first]);
+    item.album = strings.intern(snapshot.album[first]);
+    item.genre = strings.intern(snapshot.genre[first]);
+    const char* date = snapshot.date[first];
+    if (date && strlen(date) >= 4) item.year = strings.intern(date, 4);
+    item.rating = snapshot.rating[first];
+
+    uint32_t representative = first;
+    for (uint32_t row : rows) {
+        item.tracks.add_item(snapshot.handles[row]);
+        add_disc_to_item(item, snapshot.disc[row]);
+        if (is_better_representative(snapshot.disc[row], snapshot.path[row],
+                                     snapshot.disc[representative], snapshot.path[representative])) {
+            representative = row;
+        }
+        if (snapshot.release_date_key[row] > item.release_date_key) {
+            item.release_date_key = snapshot.release_date_key[row];
+        }
+        // Track newest date and total size
+        if (snapshot.timestamp[row] > item.newest_date) item.newest_date = snapshot.timestamp[row];
+        item.total_size += snapshot.size[row];
+        snapshot.owner[row] = &item;
+    }
+    item.representative_track = snapshot.handles[representative];
+
+    uint8_t dc = popcount_u32(item.disc_mask);
+    item.disc_count = (dc == 0 ? 1 : dc);
+    item.cached_label_format = -1;
+    item.cached_order_id = 0;
+    item.search_id = albumart_grid::search_index::no_entry;
+}
 
-    bool m_search_visible;  // Is search box visible
+// v10.0.52: Builds the grid item for one group; the display name comes from the
+// group's first track. Runs on a grouping worker.
+template <typename Extractor>
+static std::unique_ptr<grid_item> build_grid_item(track_snapshot& snapshot,
+                                                  const albumart_grid::track_group& group,
+                                                  Extractor& extractor) {
+    try {
+        const uint32_t first = group.members[0];
+        auto item = std::make_unique<grid_item>();
+        pfc::string8 key, display_name;
+        extractor(snapshot.handles[first], snapshot.info_at(first), snapshot.directory_at(first), key, display_name);
+        item->display_name = snapshot.strings->intern(display_name.c_str(), display_name.length());
+        item->sort_key = snapshot.strings->intern(group.key.data(), group.key.size());
+        fold_group_rows(*item, snapshot, group.members);
+        return item;
+    } catch (...) {
+        console::print("[Album Art Grid v10.0.52] Warning: Failed to build a group, skipping");
+        return nullptr;
+    }
+}
 
-    // Auto-scroll setting moved to grid_config for persistence
+// v10.0.52: Loads the snapshot rows and groups them with the given extractor, then
+// builds one grid_item per group, both on the sharded grouping engine. Items come
+// out in the order the old std::map-based loop produced them.
+template <typename Extractor>
+static void group_items_with(track_snapshot& snapshot, const Extractor& extractor,
+                             std::vector<std::unique_ptr<grid_item>>& out_items,
+                             const std::atomic<bool>* cancel = nullptr) {
+    const t_size track_count = snapshot.get_count();
+    albumart_grid::grouping_options options;
+    options.cancel = cancel;
+    std::vector<albumart_grid::track_group> groups = albumart_grid::group_tracks_sharded(track_count,
+        [&snapshot, track_count, shard_extractor = extractor, key = pfc::string8(), display_name = pfc::string8()]
+        (size_t i, std::string& out_key) mutable -> bool {
+            try {
+                const metadb_handle_ptr& handle = snapshot.handles[i];
+                // Add null check for handle (v10.0.4 crash fix)
+                if (!handle.is_valid()) {
+                    console::print("[Album Art Grid v10.0.4] Warning: Null handle encountered at index ", i);
+                    return false;
+                }
+                const file_info* info = snapshot.load_row(i);
+                key.reset();
+                display_name.reset();
+                shard_extractor(handle, info, snapshot.directory_at(i), key, display_name);
+                out_key.assign(key.c_str(), key.length());
+                return true;
+            } catch (...) {
+                // If processing of one item fails, log it and continue with the next
+                console::printf("[Album Art Grid v10.0.3] Warning: Failed to process item %u of %u, skipping",
+                               (unsigned)i + 1, (unsigned)track_count);
+                return false;
+            }
+        }, options);
 
-    int m_scroll_pos;
+    std::vector<std::unique_ptr<grid_item>> built(groups.size());
+    albumart_grid::parallel_for_chunks(groups.size(), 32, 0, [&](size_t begin, size_t end) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) return;
+        Extractor local_extractor = extractor;
+        for (size_t g = begin; g < end; ++g) {
+            built[g] = build_grid_item(snapshot, groups[g], local_extractor);
+        }
+    });
 
-    std::set<int> m_selected_indices;  // Multi-select support
+    out_items.reserve(out_items.size() + built.size());
+    for (auto& item : built) {
+        if (item) out_items.push_back(std::move(item));
+    }
+}
 
-    int m_last_selected;  // For shift-select
+// v10.0.52: Calls fn with the key extractor for the grouping mode. This is the one
+// place the mode is switched on; everything fn instantiates is mode-specific.
+template <typename Fn>
+static void with_group_key_extractor(grid_config::group_mode grouping, Fn&& fn) {
+    switch (grouping) {
+        case grid_config::GROUP_BY_FOLDER: fn(group_key_folder()); break;
+        case grid_config::GROUP_BY_ALBUM: fn(group_key_album<false>()); break;
+        case grid_config::GROUP_BY_ARTIST: fn(group_key_meta<artist_key_traits>()); break;
+        case grid_config::GROUP_BY_ARTIST_ALBUM: fn(group_key_album<true>()); break;
+        case grid_config::GROUP_BY_GENRE: fn(group_key_meta<genre_key_traits>()); break;
+        case grid_config::GROUP_BY_YEAR: fn(group_key_meta<year_key_traits>()); break;
+        case grid_config::GROUP_BY_LABEL: fn(group_key_meta<label_key_traits>()); break;
+        case grid_config::GROUP_BY_COMPOSER: fn(group_key_meta<composer_key_traits>()); break;
+        case grid_config::GROUP_BY_PERFORMER: fn(group_key_meta<performer_key_traits>()); break;
+        case grid_config::GROUP_BY_ALBUM_ARTIST: fn(group_key_meta<album_artist_key_traits>()); break;
+        case grid_config::GROUP_BY_DIRECTORY: fn(group_key_directory()); break;
+        case grid_config::GROUP_BY_COMMENT: fn(group_key_meta<comment_key_traits>()); break;
+        case grid_config::GROUP_BY_RATING: fn(group_key_meta<rating_key_traits>()); break;
+    }
+}
 
-    int m_hover_index;
+// cancel, if given, is polled between shards; a cancelled call leaves out_items
+// incomplete and the caller is expected to throw the result away
+static void group_items(track_snapshot& snapshot, grid_config::group_mode grouping,
+                        std::vector<std::unique_ptr<grid_item>>& out_items,
+                        const std::atomic<bool>* cancel = nullptr) {
+    with_group_key_extractor(grouping, [&](const auto& extractor) {
+        group_items_with(snapshot, extractor, out_items, cancel);
+    });
+}
 
-    int m_tooltip_index;  // Index of item tooltip is showing for
+// v10.0.52: Loads the given snapshot rows and computes their group keys, in parallel
+// only past one chunk: the small deltas of library callbacks stay on this thread.
+// A row whose key could not be computed gets an empty key.
+template <typename Extractor>
+static void key_snapshot_rows(track_snapshot& snapshot, const Extractor& extractor,
+                              const std::vector<uint32_t>& rows, std::vector<std::string>& keys) {
+    keys.assign(rows.size(), std::string());
+    albumart_grid::parallel_for_chunks(rows.size(), 2048, 0, [&](size_t begin, size_t end) {
+        Extractor local_extractor = extractor;
+        pfc::string8 key, display_name;
+        for (size_t i = begin; i < end; ++i) {
+            try {
+                const metadb_handle_ptr& handle = snapshot.handles[rows[i]];
+                if (!handle.is_valid()) continue;
+                const file_info* info = snapshot.load_row(rows[i]);
+                key.reset();
+                display_name.reset();
+                local_extractor(handle, info, snapshot.directory_at(rows[i]), key, display_name);
+                keys[i].assign(key.c_str(), key.length());
+            } catch (...) {
+                keys[i].clear();
+            }
+        }
+    });
+}
 
-    int m_mouse_x, m_mouse_y;  // v10.0.30: Current mouse position for floating labels
+// v10.0.52: Binary sort keys. For every sort_spec an item gets a byte string whose
+// memcmp order (shorter prefix first, as std::string compares) is the item order,
+// so sorting compares flat bytes instead of re-folding case through the items.
+// Each field adds a self-delimiting segment: text is case folded and NUL-terminated,
+// numbers are big-endian; a descending field has its bytes inverted. The raw group
+// key comes last and breaks every tie.
+//
+// Case folding is LCMapStringEx's linguistic lowercase plus the Unicode full
+// foldings that lowercasing leaves apart (CaseFolding.txt, status F, and final
+// sigma), so "STRASSE" and "straße" or "ﬁle" and "FILE" get the same key.
+static void fold_case_expansions(std::wstring& wide) {
+    bool any = false;
+    for (wchar_t c : wide) any = any || c == 0x00DF || c == 0x1E9E || c == 0x0149 || c == 0x01F0 || c == 0x03C2 || (c >= 0xFB00 && c <= 0xFB06);
+    if (!any) return;
+    std::wstring folded;
+    folded.reserve(wide.size() + 8);
+    for (wchar_t c : wide) {
+        switch (c) {
+            case 0x00DF: case 0x1E9E: folded += L"ss"; break;       // sharp s
+            case 0x0149: folded += L"\x02BCn"; break;               // n preceded by apostrophe
+            case 0x01F0: folded += L"j\x030C"; break;               // j with caron
+            case 0x03C2: folded += (wchar_t)0x03C3; break;          // final sigma
+            case 0xFB00: folded += L"ff"; break;
+            case 0xFB01: folded += L"fi"; break;
+            case 0xFB02: folded += L"fl"; break;
+            case 0xFB03: folded += L"ffi"; break;
+            case 0xFB04: folded += L"ffl"; break;
+            case 0xFB05: case 0xFB06: folded += L"st"; break;
+            default: folded += c; break;
+        }
+    }
+    wide.swap(folded);
+}
 
-    service_ptr_t<ui_element_instance_callback> m_callback;
+static void append_folded_text(std::string& out, const char* text, size_t length) {
+    bool ascii = true;
+    for (size_t i = 0; i < length && ascii; i++) ascii = (unsigned char)text[i] < 0x80;
+    if (ascii) {
+        for (size_t i = 0; i < length; i++) {
+            char c = text[i];
+            out.push_back(c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c);
+        }
+        return;
+    }
+    int wide_len = MultiByteToWideChar(CP_UTF8, 0, text, (int)length, NULL, 0);
+    if (wide_len <= 0) {
+        out.append(text, length);
+        return;
+    }
+    std::wstring source(wide_len, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, text, (int)length, &source[0], wide_len);
+    const DWORD flags = LCMAP_LOWERCASE | LCMAP_LINGUISTIC_CASING;
+    const int lower_len = LCMapStringEx(LOCALE_NAME_INVARIANT, flags, source.data(), wide_len, NULL, 0, NULL, NULL, 0);
+    std::wstring wide;
+    if (lower_len > 0) {
+        wide.resize(lower_len);
+        LCMapStringEx(LOCALE_NAME_INVARIANT, flags, source.data(), wide_len, &wide[0], lower_len, NULL, NULL, 0);
+    } else {
+        wide = source;
+        CharLowerBuffW(&wide[0], (DWORD)wide.size());
+    }
+    fold_case_expansions(wide);
+    wide_len = (int)wide.size();
+    int utf8_len = WideCharToMultiByte(CP_UTF8, 0, wide.data(), wide_len, NULL, 0, NULL, NULL);
+    if (utf8_len <= 0) {
+        out.append(text, length);
+        return;
+    }
+    const size_t at = out.size();
+    out.resize(at + utf8_len);
+    WideCharToMultiByte(CP_UTF8, 0, wide.data(), wide_len, &out[at], utf8_len, NULL, NULL);
+}
 
-    grid_config m_config;
+static void append_folded_text(std::string& out, const albumart_grid::pooled_string& text) {
+    append_folded_text(out, text.c_str(), text.length());
+}
 
-    fb2k::CCoreDarkModeHooks m_dark;
+static void append_number(std::string& out, uint64_t value, int bytes, bool descending) {
+    if (descending) value = ~value;
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) out.push_back((char)(value >> shift));
+}
 
-    std::atomic<bool> m_is_destroying;  // Atomic flag to prevent use-after-free in playlist callbacks
+static void append_text(std::string& out, const albumart_grid::pooled_string& text, bool descending) {
+    const size_t at = out.size();
+    append_folded_text(out, text);
+    out.push_back('\0');
+    if (descending) {
+        for (size_t i = at; i < out.size(); i++) out[i] = (char)~(unsigned char)out[i];
+    }
+}
+
+// Four-digit years by number, then any other text, then items without a year
+static void append_year_key(std::string& out, const albumart_grid::pooled_string& year, bool descending) {
+    if (year.length() == 4 && std::isdigit((unsigned char)year[0]) && std::isdigit((unsigned char)year[1]) &&
+        std::isdigit((unsigned char)year[2]) && std::isdigit((unsigned char)year[3])) {
+        out.push_back('\0');
+        append_number(out, (uint64_t)atoi(year.c_str()), 2, descending);
+    } else if (!year.is_empty()) {
+        out.push_back('\1');
+        append_text(out, year, descending);
+    } else {
+        out.push_back('\2');
+    }
+}
+
+static void append_field_key(std::string& out, const grid_config::sort_key& key, const grid_item& item) {
+    const bool desc = key.descending;
+    switch (key.field) {
+        case grid_config::SORT_BY_NAME: append_text(out, item.sort_key, desc); break;
+        case grid_config::SORT_BY_DATE: append_number(out, item.newest_date, 8, desc); break;
+        case grid_config::SORT_BY_TRACK_COUNT: append_number(out, item.tracks.get_count(), 4, desc); break;
+        case grid_config::SORT_BY_ARTIST: append_text(out, item.artist, desc); break;
+        case grid_config::SORT_BY_ALBUM: append_text(out, item.album, desc); break;
+        case grid_config::SORT_BY_YEAR: append_year_key(out, item.year, desc); break;
+        case grid_config::SORT_BY_GENRE: append_text(out, item.genre, desc); break;
+        case grid_config::SORT_BY_PATH: append_text(out, item.path, desc); break;
+        case grid_config::SORT_BY_SIZE: append_number(out, item.total_size, 8, desc); break;
+        case grid_config::SORT_BY_RATING: append_number(out, (uint32_t)item.rating ^ 0x80000000u, 4, desc); break;
+        case grid_config::SORT_BY_RELEASE_DATE:
+            // Items without a release date go last either way
+            if (item.release_date_key != 0) {
+                out.push_back('\0');
+                append_number(out, item.release_date_key, 4, desc);
+            } else {
+                out.push_back('\1');
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void build_order_key(const grid_config::sort_spec& sorting, const grid_item& item, std::string& out) {
+    out.clear();
+    for (int i = 0; i < sorting.count; i++) append_field_key(out, sorting.keys[i], item);
+    out.append(item.sort_key.c_str(), item.sort_key.length());
+}
+
+static const std::string& get_order_key(const grid_item& item, const grid_config::sort_spec& sorting) {
+    const uint32_t id = sorting.id();
+    if (item.cached_order_id != id) {
+        build_order_key(sorting, item, item.cached_order_key);
+        item.cached_order_id = id;
+    }
+    return item.cached_order_key;
+}
+
+// v10.0.52: Item order of a grid_config::sort_spec. A random spec has no order.
+static bool grid_item_less(const grid_config::sort_spec& sorting, const grid_item& a, const grid_item& b) {
+    if (sorting.is_random()) return false;
+    return get_order_key(a, sorting) < get_order_key(b, sorting);
+}
+
+// v10.0.52: Fields offered under Sort > Then By (menu commands 73-83) and
+// Sort > And Then By (85-95)
+static const struct { grid_config::sort_mode field; const TCHAR* label; } g_then_by_fields[] = {
+    { grid_config::SORT_BY_NAME, TEXT("Name") },
+    { grid_config::SORT_BY_ARTIST, TEXT("Artist") },
+    { grid_config::SORT_BY_ALBUM, TEXT("Album") },
+    { grid_config::SORT_BY_YEAR, TEXT("Year") },
+    { grid_config::SORT_BY_GENRE, TEXT("Genre") },
+    { grid_config::SORT_BY_DATE, TEXT("Date Modified") },
+    { grid_config::SORT_BY_RELEASE_DATE, TEXT("Release Date") },
+    { grid_config::SORT_BY_SIZE, TEXT("Total Size") },
+    { grid_config::SORT_BY_TRACK_COUNT, TEXT("Track Count") },
+    { grid_config::SORT_BY_RATING, TEXT("Rating") },
+    { grid_config::SORT_BY_PATH, TEXT("Path") },
+};
+
+// v10.0.52: The keys are copied into one buffer and radix sorted as (key, index)
+// pairs; the items are then permuted once. Keys are built, and sorted by
+// sort_keys_parallel(), on as many threads as the model has chunks of work for;
+// small models and single-core machines stay on this thread.
+static void sort_grid_items(std::vector<std::unique_ptr<grid_item>>& items, const grid_config::sort_spec& sorting) {
+    if (sorting.is_random()) {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::shuffle(items.begin(), items.end(), gen);
+        return;
+    }
+    if (items.size() < 2) return;
+    // Each item only touches its own key cache
+    albumart_grid::parallel_for_chunks(items.size(), 2048, 0, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) get_order_key(*items[i], sorting);
+    });
+    std::vector<uint32_t> offsets;
+    offsets.reserve(items.size() + 1);
+    offsets.push_back(0);
+    size_t total = 0;
+    for (const auto& item : items) {
+        total += get_order_key(*item, sorting).size();
+        offsets.push_back((uint32_t)total);
+    }
+    std::vector<unsigned char> bytes(total);
+    for (size_t i = 0; i < items.size(); i++) {
+        const std::string& key = items[i]->cached_order_key;
+        if (!key.empty()) memcpy(bytes.data() + offsets[i], key.data(), key.size());
+    }
+    albumart_grid::radix_key_sorter sorter(bytes.data(), offsets.data(), items.size());
+    const std::vector<uint32_t> order = sorter.sort_keys_parallel();
+    std::vector<std::unique_ptr<grid_item>> sorted;
+    sorted.reserve(items.size());
+    for (uint32_t index : order) sorted.push_back(std::move(items[index]));
+    items.swap(sorted);
+}
+
+// v10.0.52: Model cache (src/core/model_cache.h). The rebuild worker writes the
+// finished library model to the profile directory; on startup it is mapped and
+// painted before the first rebuild lands.
+static bool get_model_cache_path(std::wstring& out) {
+    pfc::string8 native;
+    if (!filesystem::g_get_native_path(core_api::get_profile_path(), native)) return false;
+    native << "\\foo_albumart_grid.model";
+    out = pfc::stringcvt::string_wide_from_utf8(native).get_ptr();
+    return true;
+}
+
+// The fields of a model that go into the cache, copied so the image can be
+// serialized off the UI thread while the panel goes on changing its items. The
+// text stays in the model's string pool, which the copy keeps alive.
+struct model_cache_source {
+    struct entry {
+        albumart_grid::pooled_string display_name, folder_name, sort_key, path, artist, album, genre, year;
+        t_filetimestamp newest_date = 0;
+        t_filesize total_size = 0;
+        int rating = 0;
+        uint32_t release_date_key = 0;
+        uint32_t disc_mask = 0;
+        uint8_t disc_count = 1;
+        metadb_handle_list tracks;
+        metadb_handle_ptr representative_track;
+    };
+    std::vector<entry> entries;
+    std::shared_ptr<albumart_grid::string_pool> strings;
+    grid_config::view_mode view = grid_config::VIEW_LIBRARY;
+    grid_config::group_mode grouping = grid_config::GROUP_BY_FOLDER;
+    grid_config::sort_spec sorting;  // the order `entries` are in
+};
+
+static void capture_model_cache_source(const std::vector<std::unique_ptr<grid_item>>& items, const track_snapshot& snapshot,
+                                       grid_config::view_mode view, grid_config::group_mode grouping,
+                                       const grid_config::sort_spec& sorting, model_cache_source& out) {
+    out.entries.clear();
+    out.entries.reserve(items.size());
+    for (const auto& item : items) {
+        out.entries.emplace_back();
+        model_cache_source::entry& rec = out.entries.back();
+        rec.display_name = item->display_name;
+        rec.folder_name = item->folder_name;
+        rec.sort_key = item->sort_key;
+        rec.path = item->path;
+        rec.artist = item->artist;
+        rec.album = item->album;
+        rec.genre = item->genre;
+        rec.year = item->year;
+        rec.newest_date = item->newest_date;
+        rec.total_size = item->total_size;
+        rec.rating = item->rating;
+        rec.release_date_key = item->release_date_key;
+        rec.disc_mask = item->disc_mask;
+        rec.disc_count = item->disc_count;
+        rec.tracks = item->tracks;
+        rec.representative_track = item->representative_track;
+    }
+    out.strings = snapshot.strings;
+    out.view = view;
+    out.grouping = grouping;
+    out.sorting = sorting;
+}
+
+static std::vector<char> serialize_model(const model_cache_source& source) {
+    albumart_grid::model_cache_writer writer;
+    auto text = [&writer](const albumart_grid::pooled_string& value) { return writer.add_string(value.c_str(), value.length()); };
+    for (const auto& item : source.entries) {
+        albumart_grid::model_cache_item& rec = writer.add_item();
+        rec.display_name = text(item.display_name);
+        rec.folder_name = text(item.folder_name);
+        rec.sort_key = text(item.sort_key);
+        rec.path = text(item.path);
+        rec.artist = text(item.artist);
+        rec.album = text(item.album);
+        rec.genre = text(item.genre);
+        rec.year = text(item.year);
+        rec.newest_date = item.newest_date;
+        rec.total_size = item.total_size;
+        rec.rating = item.rating;
+        rec.release_date_key = item.release_date_key;
+        rec.disc_mask = item.disc_mask;
+        rec.disc_count = item.disc_count;
+        for (t_size t = 0; t < item.tracks.get_count(); t++) {
+            const metadb_handle_ptr& track = item.tracks[t];
+            if (track == item.representative_track) rec.representative = (uint32_t)t;
+            writer.add_track(track->get_path(), track->get_subsong_index());
+        }
+    }
+    return writer.finish((int32_t)source.view, (int32_t)source.grouping, (int32_t)source.sorting.id());
+}
+
+// Written next to the target and renamed over it, so readers never see half a file
+static void write_model_cache(const std::wstring& path, const std::vector<char>& image) {
+    const std::wstring temp = path + L".tmp";
+    HANDLE file = CreateFileW(temp.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return;
+    DWORD written = 0;
+    bool ok = WriteFile(file, image.data(), (DWORD)image.size(), &written, NULL) && written == image.size();
+    CloseHandle(file);
+    if (!ok || !MoveFileExW(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileW(temp.c_str());
+    }
+}
+
+// Read-only mapping of a whole file; data() is null if it could not be mapped
+class mapped_file {
+public:
+    explicit mapped_file(const wchar_t* path) {
+        m_file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (m_file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0 || (uint64_t)size.QuadPart > SIZE_MAX) return;
+        m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!m_mapping) return;
+        m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (m_view) m_size = (size_t)size.QuadPart;
+    }
+    ~mapped_file() {
+        if (m_view) UnmapViewOfFile(m_view);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+    }
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const void* data() const { return m_view; }
+    size_t size() const { return m_size; }
+
+private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = NULL;
+    const void* m_view = nullptr;
+    size_t m_size = 0;
+};
+
+// v10.0.52: Decode-at-scale for thumbnails. A JPEG whose longer side is at least twice
+// the target is decoded through WIC at 1/2, 1/4 or 1/8 of its size, the smallest that
+// still covers the target: the codec scales in the DCT domain, so the pixels dropped
+// are never decoded, and create_thumbnail() does the final high-quality resample.
+// nullptr for anything else or on any failure; the caller then decodes in full.
+// Usable on any thread that has COM (the UI thread and ThreadPool workers do).
+//
+// One factory serves the process (IWICImagingFactory is free-threaded). The first
+// caller creates it; release_wic_factory() drops it from initquit, never a static
+// destructor, and callers hold their own reference meanwhile.
+static critical_section g_wic_sync;
+static IWICImagingFactory* g_wic_factory = nullptr;
+static bool g_wic_failed = false;  // no WIC on this system: not tried again
+
+static pfc::com_ptr_t<IWICImagingFactory> wic_factory() {
+    insync(g_wic_sync);
+    if (!g_wic_factory && !g_wic_failed) {
+        const HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER, __uuidof(IWICImagingFactory), (void**)&g_wic_factory);
+        if (FAILED(hr)) {
+            g_wic_factory = nullptr;
+            g_wic_failed = hr != CO_E_NOTINITIALIZED;  // a thread without COM: the next caller may have it
+        }
+    }
+    return g_wic_factory;
+}
+
+static void release_wic_factory() {
+    insync(g_wic_sync);
+    if (g_wic_factory) g_wic_factory->Release();
+    g_wic_factory = nullptr;
+    g_wic_failed = true;
+}
+
+static Gdiplus::Bitmap* decode_jpeg_at_scale(const void* data, size_t size, int target) {
+    if (target <= 0 || size > MAXDWORD) return nullptr;
+    if (albumart_grid::sniff_image_format(data, size) != albumart_grid::image_format::jpeg) return nullptr;
+    uint32_t width = 0, height = 0;
+    if (!albumart_grid::read_jpeg_size(data, size, width, height)) return nullptr;
+    const unsigned denominator = albumart_grid::jpeg_scale_denominator(width, height, (uint32_t)target);
+    if (denominator == 1) return nullptr;
+    const pfc::com_ptr_t<IWICImagingFactory> factory = wic_factory();
+    if (factory.is_empty()) return nullptr;
+
+    // The stream reads the artwork in place
+    pfc::com_ptr_t<IWICStream> stream;
+    pfc::com_ptr_t<IWICBitmapDecoder> decoder;
+    pfc::com_ptr_t<IWICBitmapFrameDecode> frame;
+    pfc::com_ptr_t<IWICBitmapSourceTransform> transform;
+    if (FAILED(factory->CreateStream(stream.receive_ptr()))) return nullptr;
+    if (FAILED(stream->InitializeFromMemory((BYTE*)data, (DWORD)size))) return nullptr;
+    if (FAILED(factory->CreateDecoderFromStream(stream.get_ptr(), NULL, WICDecodeMetadataCacheOnDemand, decoder.receive_ptr()))) return nullptr;
+    if (FAILED(decoder->GetFrame(0, frame.receive_ptr()))) return nullptr;
+    UINT frame_width = 0, frame_height = 0;
+    if (FAILED(frame->GetSize(&frame_width, &frame_height)) || frame_width != width || frame_height != height) return nullptr;
+    if (FAILED(frame->QueryInterface(__uuidof(IWICBitmapSourceTransform), transform.receive_void_ptr()))) return nullptr;
+
+    // Only a size the codec reaches natively; anything else would be a full decode
+    const UINT scaled_width = albumart_grid::jpeg_scaled_dimension(width, denominator);
+    const UINT scaled_height = albumart_grid::jpeg_scaled_dimension(height, denominator);
+    UINT closest_width = scaled_width, closest_height = scaled_height;
+    if (FAILED(transform->GetClosestSize(&closest_width, &closest_height))) return nullptr;
+    if (closest_width != scaled_width || closest_height != scaled_height) return nullptr;
+
+    // Decode in the codec's own pixel format, then convert to GDI+'s PARGB
+    WICPixelFormatGUID format = GUID_WICPixelFormat32bppPBGRA;
+    if (FAILED(transform->GetClosestPixelFormat(&format))) return nullptr;
+    pfc::com_ptr_t<IWICBitmap> scaled;
+    if (FAILED(factory->CreateBitmap(scaled_width, scaled_height, format, WICBitmapCacheOnLoad, scaled.receive_ptr()))) return nullptr;
+    {
+        pfc::com_ptr_t<IWICBitmapLock> lock;
+        WICRect all = { 0, 0, (INT)scaled_width, (INT)scaled_height };
+        UINT stride = 0, buffer_size = 0;
+        BYTE* buffer = nullptr;
+        if (FAILED(scaled->Lock(&all, WICBitmapLockWrite, lock.receive_ptr()))) return nullptr;
+        if (FAILED(lock->GetStride(&stride)) || FAILED(lock->GetDataPointer(&buffer_size, &buffer))) return nullptr;
+        if (FAILED(transform->CopyPixels(NULL, scaled_width, scaled_height, &format, WICBitmapTransformRotate0, stride, buffer_size, buffer))) return nullptr;
+    }
+    pfc::com_ptr_t<IWICFormatConverter> converter;
+    if (FAILED(factory->CreateFormatConverter(converter.receive_ptr()))) return nullptr;
+    if (FAILED(converter->Initialize(scaled.get_ptr(), GUID_WICPixelFormat32bppPBGRA, WICBitmapDitherTypeNone, NULL, 0.0, WICBitmapPaletteTypeCustom))) return nullptr;
+
+    std::unique_ptr<Gdiplus::Bitmap> bitmap(new Gdiplus::Bitmap((INT)scaled_width, (INT)scaled_height, PixelFormat32bppPARGB));
+    if (bitmap->GetLastStatus() != Gdiplus::Ok) return nullptr;
+    Gdiplus::Rect rect(0, 0, (INT)scaled_width, (INT)scaled_height);
+    Gdiplus::BitmapData bits;
+    if (bitmap->LockBits(&rect, Gdiplus::ImageLockModeWrite, PixelFormat32bppPARGB, &bits) != Gdiplus::Ok) return nullptr;
+    const HRESULT copied = converter->CopyPixels(NULL, (UINT)bits.Stride, (UINT)bits.Stride * scaled_height, (BYTE*)bits.Scan0);
+    bitmap->UnlockBits(&bits);
+    return SUCCEEDED(copied) ? bitmap.release() : nullptr;
+}
+
+// v10.0.52: Resamples all of source into all of target with our own premultiplied
+// resampler (src/core/resample.h: area-average plus Lanczos-3, SIMD picked at runtime)
+// instead of DrawImage. False if either bitmap cannot be locked as PARGB; the caller
+// then draws with GDI+ as before.
+static bool resample_bitmap(Gdiplus::Bitmap* source, Gdiplus::Bitmap* target) {
+    if (!source || !target) return false;
+    Gdiplus::Rect source_rect(0, 0, (INT)source->GetWidth(), (INT)source->GetHeight());
+    Gdiplus::Rect target_rect(0, 0, (INT)target->GetWidth(), (INT)target->GetHeight());
+    Gdiplus::BitmapData source_bits, target_bits;
+    if (source->LockBits(&source_rect, Gdiplus::ImageLockModeRead, PixelFormat32bppPARGB, &source_bits) != Gdiplus::Ok) return false;
+    if (target->LockBits(&target_rect, Gdiplus::ImageLockModeWrite, PixelFormat32bppPARGB, &target_bits) != Gdiplus::Ok) {
+        source->UnlockBits(&source_bits);
+        return false;
+    }
+    const albumart_grid::pixel_view from = { static_cast<const uint8_t*>(source_bits.Scan0), (int)source_bits.Width, (int)source_bits.Height, source_bits.Stride };
+    const albumart_grid::pixel_target to = { static_cast<uint8_t*>(target_bits.Scan0), (int)target_bits.Width, (int)target_bits.Height, target_bits.Stride };
+    albumart_grid::resample_thumbnail(from, to);
+    target->UnlockBits(&target_bits);
+    source->UnlockBits(&source_bits);
+    return true;
+}
+
+// v10.0.52: Read-only IStream over encoded artwork, so GDI+ decodes the album_art_data
+// buffer in place instead of a GlobalAlloc copy of it. The stream holds a reference on
+// the artwork: a GDI+ bitmap may go on reading its stream after FromStream() returns.
+class artwork_stream : public IStream {
+public:
+    // New stream with one reference, which the caller releases
+    static IStream* open(const album_art_data_ptr& art) {
+        if (!art.is_valid() || art->get_size() == 0 || art->get_size() > MAXDWORD) return nullptr;
+        return new (std::nothrow) artwork_stream(art, 0);
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** out) override {
+        if (!out) return E_POINTER;
+        if (riid == IID_IUnknown || riid == IID_ISequentialStream || riid == IID_IStream) {
+            *out = static_cast<IStream*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *out = nullptr;
+        return E_NOINTERFACE;
+    }
+    ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refs; }
+    ULONG STDMETHODCALLTYPE Release() override {
+        const ULONG left = --m_refs;
+        if (left == 0) delete this;
+        return left;
+    }
+
+    HRESULT STDMETHODCALLTYPE Read(void* buffer, ULONG wanted, ULONG* read) override {
+        if (!buffer) return STG_E_INVALIDPOINTER;
+        const ULONG n = (ULONG)std::min<ULONGLONG>(wanted, remaining());
+        if (n) memcpy(buffer, m_data + m_pos, n);
+        m_pos += n;
+        if (read) *read = n;
+        return n == wanted ? S_OK : S_FALSE;
+    }
+    HRESULT STDMETHODCALLTYPE Write(const void*, ULONG, ULONG*) override { return STG_E_ACCESSDENIED; }
+
+    HRESULT STDMETHODCALLTYPE Seek(LARGE_INTEGER move, DWORD origin, ULARGE_INTEGER* position) override {
+        LONGLONG from;
+        switch (origin) {
+            case STREAM_SEEK_SET: from = 0; break;
+            case STREAM_SEEK_CUR: from = (LONGLONG)m_pos; break;
+            case STREAM_SEEK_END: from = (LONGLONG)m_size; break;
+            default: return STG_E_INVALIDFUNCTION;
+        }
+        if (from + move.QuadPart < 0) return STG_E_INVALIDFUNCTION;
+        m_pos = (ULONGLONG)(from + move.QuadPart);
+        if (position) position->QuadPart = m_pos;
+        return S_OK;
+    }
+    HRESULT STDMETHODCALLTYPE SetSize(ULARGE_INTEGER) override { return STG_E_ACCESSDENIED; }
+    HRESULT STDMETHODCALLTYPE CopyTo(IStream* target, ULARGE_INTEGER count, ULARGE_INTEGER* read, ULARGE_INTEGER* written) override {
+        if (!target) return STG_E_INVALIDPOINTER;
+        const ULONG n = (ULONG)std::min<ULONGLONG>(count.QuadPart, remaining());
+        ULONG done = 0;
+        const HRESULT hr = n ? target->Write(m_data + m_pos, n, &done) : S_OK;
+        m_pos += done;
+        if (read) read->QuadPart = done;
+        if (written) written->QuadPart = done;
+        return hr;
+    }
+    HRESULT STDMETHODCALLTYPE Commit(DWORD) override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE Revert() override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return STG_E_INVALIDFUNCTION; }
+    HRESULT STDMETHODCALLTYPE UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return STG_E_INVALIDFUNCTION; }
+    HRESULT STDMETHODCALLTYPE Stat(STATSTG* stat, DWORD) override {
+        if (!stat) return STG_E_INVALIDPOINTER;
+        memset(stat, 0, sizeof(*stat));
+        stat->type = STGTY_STREAM;
+        stat->cbSize.QuadPart = m_size;
+        stat->grfMode = STGM_READ;
+        return S_OK;
+    }
+    HRESULT STDMETHODCALLTYPE Clone(IStream** out) override {
+        if (!out) return STG_E_INVALIDPOINTER;
+        *out = new (std::nothrow) artwork_stream(m_art, m_pos);
+        return *out ? S_OK : E_OUTOFMEMORY;
+    }
+
+private:
+    artwork_stream(const album_art_data_ptr& art, ULONGLONG pos)
+        : m_art(art), m_data(static_cast<const BYTE*>(art->get_ptr())), m_size(art->get_size()), m_pos(pos) {}
+    ULONGLONG remaining() const { return m_pos < m_size ? m_size - m_pos : 0; }
+
+    std::atomic<ULONG> m_refs{1};
+    album_art_data_ptr m_art;  // keeps m_data alive
+    const BYTE* m_data;
+    ULONGLONG m_size;
+    ULONGLONG m_pos;
+};
+
+// v10.0.52: Artwork loader statistics, printed at shutdown. A load's bytes are what it
+// held at once on top of the artwork as the SDK handed it over (which is now decoded
+// in place): the decoded image and the resampled result.
+struct artwork_load_stats {
+    static std::atomic<uint64_t> loads;
+    static std::atomic<uint64_t> encoded_bytes;
+    static std::atomic<uint64_t> load_bytes;
+    static std::atomic<uint64_t> peak_load_bytes;
+
+    static uint64_t bitmap_bytes(Gdiplus::Bitmap* bitmap) {
+        if (!bitmap) return 0;
+        return (uint64_t)bitmap->GetWidth() * bitmap->GetHeight() * Gdiplus::GetPixelFormatSize(bitmap->GetPixelFormat()) / 8;
+    }
+
+    static void record(size_t encoded, uint64_t bytes) {
+        loads++;
+        encoded_bytes += encoded;
+        load_bytes += bytes;
+        uint64_t peak = peak_load_bytes.load();
+        while (bytes > peak && !peak_load_bytes.compare_exchange_weak(peak, bytes)) {}
+    }
+
+    static void print() {
+        const uint64_t count = loads.load();
+        if (count == 0) return;
+        console::printf("[Album Art Grid v10.0.52] Artwork loads: %u, %u KB encoded (read in place), %u KB per load on average, %u KB at most",
+            (unsigned)count, (unsigned)(encoded_bytes.load() / 1024), (unsigned)(load_bytes.load() / count / 1024),
+            (unsigned)(peak_load_bytes.load() / 1024));
+    }
+};
+std::atomic<uint64_t> artwork_load_stats::loads{0};
+std::atomic<uint64_t> artwork_load_stats::encoded_bytes{0};
+std::atomic<uint64_t> artwork_load_stats::load_bytes{0};
+std::atomic<uint64_t> artwork_load_stats::peak_load_bytes{0};
+
+// v10.0.52: Text an item is found by - name, artist, album and genre - case folded
+// like the order keys, so a query folded by fold_search_text() matches regardless of case
+static void build_search_text(const grid_item& item, std::string& out) {
+    out.clear();
+    append_folded_text(out, item.display_name);
+    out.push_back(' ');
+    append_folded_text(out, item.artist);
+    out.push_back(' ');
+    append_folded_text(out, item.album);
+    out.push_back(' ');
+    append_folded_text(out, item.genre);
+}
+
+static std::string fold_search_text(const pfc::string8& text) {
+    std::string out;
+    append_folded_text(out, text.c_str(), text.length());
+    return out;
+}
+
+// Search match for single items (incremental updates); query is folded
+static bool grid_item_matches_search(const grid_item& item, const std::string& query) {
+    std::string text;
+    build_search_text(item, text);
+    return text.find(query) != std::string::npos;
+}
+
+
+
+class album_grid_instance : public ui_element_instance,
+
+                          public playlist_callback_single,
+
+                          public validated_object {
+
+private:
+
+    // CRITICAL FIX: Manual reference counting
+
+    volatile long m_refcount;
+
+    
+
+    HWND m_hwnd;
+
+    HWND m_parent;
+
+    HWND m_tooltip;  // Tooltip window
+    HWND m_search_box;  // Search/filter text box
+    // Reusable back buffer for painting
+    HDC m_memdc = NULL;
+    HBITMAP m_membmp = NULL;
+    HBITMAP m_oldbmp = NULL;
+    int m_bufW = 0, m_bufH = 0;
+    HFONT m_placeholder_font = NULL;
+    int m_placeholder_font_size = 0;
+    std::vector<std::unique_ptr<grid_item>> m_items;
+    track_snapshot m_snapshot;  // v10.0.52: per-track metadata of the current view
+
+    std::vector<int> m_filtered_indices;  // Indices of filtered items
+
+    pfc::string8 m_search_text;  // Current search filter
+
+    // v10.0.52: m_search_text as matched (fold_search_text()), and the folded text of
+    // the items with a trigram index over it; see apply_filter(). A search job may
+    // hold the index, so it is replaced rather than changed while shared.
+    std::string m_search_folded;
+    std::shared_ptr<albumart_grid::search_index> m_search_index = std::make_shared<albumart_grid::search_index>();
+    // Index hits of the query last applied, while the index keeps its revision
+    std::string m_search_hits_query;
+    std::vector<uint32_t> m_search_hits;
+    uint64_t m_search_hits_revision = 0;
+
+    bool m_search_visible;  // Is search box visible
+
+    // Auto-scroll setting moved to grid_config for persistence
+
+    int m_scroll_pos;
+
+    std::set<int> m_selected_indices;  // Multi-select support
+
+    int m_last_selected;  // For shift-select
+
+    int m_hover_index;
+
+    int m_tooltip_index;  // Index of item tooltip is showing for
+
+    int m_mouse_x, m_mouse_y;  // v10.0.30: Current mouse position for floating labels
+
+    service_ptr_t<ui_element_instance_callback> m_callback;
+
+    grid_config m_config;
+
+    fb2k::CCoreDarkModeHooks m_dark;
+
+    std::atomic<bool> m_is_destroying;  // Atomic flag to prevent use-after-free in playlist callbacks
 
     bool m_tracking;
 
@@ -1732,6 +3150,7 @@ private:
     static const UINT_PTR TIMER_PROGRESSIVE = 2;
 
     static const UINT_PTR TIMER_NOW_PLAYING = 3;
+    static const UINT_PTR TIMER_POPULATE = 4;  // v10.0.52: progressive population slices
 
     
 
@@ -1751,11 +3170,13 @@ private:
 
     
 
-    // Letter jump navigation tracking
-
-    char m_last_jump_letter;
-
-    int m_last_jump_index;
+    // v10.0.52: Type-ahead (jump_to_letter()): the keys typed so far and when the last
+    // came, and the display list's labels for m_jump_label_style
+    static const ULONGLONG type_ahead_timeout_ms = 1000;
+    std::string m_type_ahead;
+    ULONGLONG m_type_ahead_tick = 0;
+    albumart_grid::jump_index m_jump_index;
+    int m_jump_label_style = -1;
 
     
 
@@ -1889,13 +3310,21 @@ private:
 
     // Async artwork loading
 
-    struct ThumbnailResult { int index; int generation; Gdiplus::Bitmap* bmp; int size; };
+    // v10.0.52: target identifies the item's thumbnail, so results still land on the
+    // right item after incremental updates have moved it; art_source names the artwork
+    // for thumbnail_cache::remember_art()
+    struct ThumbnailResult { int index; int generation; Gdiplus::Bitmap* bmp; int size; std::weak_ptr<thumbnail_data> target; std::string art_source; std::shared_ptr<artwork_level> level; };
 
     static const UINT WM_APP_THUMBNAIL_READY = WM_APP + 100;
     static const UINT WM_APP_INVALIDATE = WM_APP + 101;
     static std::atomic<int> s_inflight_loaders;
 
     static const int kMaxInflight = 4;
+    // v10.0.52: Thumbnails within this many pixels of their cell are drawn scaled as they are
+    static const int kRescaleSlack = 8;
+    // v10.0.52: Time load_visible_artwork() spends resampling per paint; the rest of
+    // the covers are drawn scaled until the following paints get to them
+    static const int kRescaleBudgetMs = 4;
     static ThreadPool& thumb_pool() { static ThreadPool pool(kMaxInflight); return pool; }
 
 
@@ -1914,6 +3343,255 @@ private:
 
     metadb_handle_ptr m_last_now_playing;
 
+    // v10.0.52: Library deltas are applied to the grouped model in place (library view only)
+    class library_delta_callback : public library_callback_dynamic_impl_base {
+    public:
+        explicit library_delta_callback(album_grid_instance* owner) : m_owner(owner) {}
+        void on_items_added(metadb_handle_list_cref items) override { m_owner->on_library_delta(&items, nullptr, nullptr); }
+        void on_items_removed(metadb_handle_list_cref items) override { m_owner->on_library_delta(nullptr, &items, nullptr); }
+        void on_items_modified(metadb_handle_list_cref items) override { m_owner->on_library_delta(nullptr, nullptr, &items); }
+    private:
+        album_grid_instance* m_owner;
+    };
+    std::unique_ptr<library_delta_callback> m_library_callback;
+    bool m_model_loaded = false;  // set once a model is swapped in; deltas before that are ignored
+    std::unordered_map<std::string, grid_item*> m_group_index;  // group key -> item, built on demand
+    bool m_group_index_ready = false;
+    // v10.0.52: Playlist view - snapshot row of every playlist entry, no_playlist_row
+    // for entries that are in no group
+    static constexpr uint32_t no_playlist_row = UINT32_MAX;
+    std::vector<uint32_t> m_playlist_rows;
+
+    // v10.0.52: What a model was built from; panels with equal keys can share it
+    struct model_key {
+        grid_config::view_mode view = grid_config::VIEW_LIBRARY;
+        grid_config::group_mode grouping = grid_config::GROUP_BY_FOLDER;
+        t_size playlist = pfc::infinite_size;  // playlist view: the active playlist...
+        uint64_t playlist_layout = 0;          // ...by its index under this shared_model_service::playlist_layout()
+        bool operator==(const model_key& other) const {
+            return view == other.view && grouping == other.grouping && playlist == other.playlist
+                && playlist_layout == other.playlist_layout;
+        }
+    };
+
+    // v10.0.52: Background model rebuilds. refresh_items() gathers the track list on the
+    // UI thread; grouping and sorting then run on model_pool() into a fresh model_build,
+    // which WM_APP_MODEL_READY swaps in. m_items keeps painting meanwhile. A newer
+    // refresh cancels the build in flight unless another panel still waits for it.
+    struct model_build {
+        uint64_t serial = 0;
+        grid_config::view_mode view = grid_config::VIEW_LIBRARY;
+        grid_config::group_mode grouping = grid_config::GROUP_BY_FOLDER;
+        grid_config::sort_spec sorting;
+        t_size playlist = pfc::infinite_size;
+        uint64_t playlist_layout = 0;
+        track_snapshot snapshot;
+        std::vector<std::unique_ptr<grid_item>> items;
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> ready{false};
+        std::wstring cache_path;        // library builds: where the model cache goes
+        std::vector<char> cache_image;  // serialized model, written after it is posted
+        unsigned consumers = 1;         // panels that will install it (UI thread)
+        std::mutex notify_sync;
+        std::vector<HWND> notify;       // windows WM_APP_MODEL_READY goes to
+        bool posted = false;            // notify has been served; later joiners post themselves
+
+        model_key key() const {
+            model_key out;
+            out.view = view;
+            out.grouping = grouping;
+            out.playlist = playlist;
+            out.playlist_layout = playlist_layout;
+            return out;
+        }
+    };
+    static const UINT WM_APP_MODEL_READY = WM_APP + 102;
+    static ThreadPool& model_pool() { static ThreadPool pool(1); return pool; }
+
+    // v10.0.52: The model cache is read on model_pool() (resolving its tracks is one
+    // handle_create() each), ahead of the first rebuild, which the pool runs after it.
+    // WM_APP_CACHE_READY hands the items over whether or not the cache could be used.
+    struct cache_restore {
+        std::wstring path;
+        grid_config::group_mode grouping = grid_config::GROUP_BY_FOLDER;
+        grid_config::sort_spec sorting;  // in: the panel's; out: the order items are in
+        track_snapshot snapshot;         // only its strings are used
+        std::vector<std::unique_ptr<grid_item>> items;
+        std::atomic<bool> loaded{false};
+    };
+    static const UINT WM_APP_CACHE_READY = WM_APP + 104;
+    std::shared_ptr<cache_restore> m_cache_restore;
+    bool m_restored_model = false;         // m_items came from the cache and is not checked yet
+    bool m_refresh_after_restore = false;  // the first refresh waits for the cache
+
+    // v10.0.52: Checks a restored model against the live library on model_pool() (see
+    // check_cached_model()) instead of rebuilding it. WM_APP_CACHE_CHECKED hands the
+    // differences to apply_row_delta(), so the restored items become the model.
+    struct cache_check {
+        uint64_t serial = 0;
+        metadb_handle_list live;
+        model_cache_source source;          // the restored items, in m_items order
+        std::vector<grid_item*> items;      // the same, for the UI side only
+        track_snapshot snapshot;            // out: rows of the restored tracks, item by item
+        std::vector<uint32_t> row_group;    // out: index into items of each row
+        std::vector<uint32_t> removed_rows; // out: tracks that left the library
+        std::vector<uint32_t> moved_rows;   // out: tracks whose group key changed
+        std::vector<uint32_t> changed;      // out: items whose folded fields changed
+        metadb_handle_list added;           // out: tracks the cache did not have
+        bool too_different = false;         // out: a rebuild is cheaper
+        std::atomic<bool> cancelled{false};
+    };
+    static const UINT WM_APP_CACHE_CHECKED = WM_APP + 105;
+    std::shared_ptr<cache_check> m_cache_check;
+    bool m_cache_check_stale = false;  // a delta arrived after the check took the live list
+
+    // v10.0.52: Search-as-you-type. Queries whose scan is long (see apply_filter())
+    // run on search_pool() against the index as it was, and WM_APP_SEARCH_READY hands
+    // the hits back. The next keystroke cancels the job in flight, and its results are
+    // dropped by serial; until then the previous results stay on screen.
+    struct search_job {
+        uint64_t serial = 0;
+        std::string query;
+        std::shared_ptr<const albumart_grid::search_index> index;
+        uint64_t revision = 0;  // of index
+        std::vector<uint32_t> hits;
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> done{false};
+    };
+    static const UINT WM_APP_SEARCH_READY = WM_APP + 103;
+    static const size_t async_search_entries = 20000;  // index entries a query checks before it goes async
+    static ThreadPool& search_pool() { static ThreadPool pool(1); return pool; }
+    std::shared_ptr<search_job> m_search_job;
+    uint64_t m_search_serial = 0;
+    static uint64_t next_build_serial() { static uint64_t serial = 0; return ++serial; }
+    std::shared_ptr<model_build> m_pending_build;
+    bool m_pending_build_stale = false;  // a delta arrived after the build took its track list
+    model_key m_model_key;               // of the installed model, if m_model_loaded (or m_restored_model)
+
+    // v10.0.52: Progressive population. A panel with nothing current to show fills its
+    // model on the UI thread in time slices of about population_slice_ms while the
+    // background build runs: every slice groups the next batches of tracks and appends
+    // the new groups (append_population_batch()), so the groups found so far are
+    // painted right away. A batch costs what it adds, not what the model holds; sorting
+    // and the other whole-model fixups run once, in finish_population(). Once the
+    // screen is full the slices stop and the build, grouped in parallel, replaces the
+    // partial model; a library small enough to finish first drops the build instead.
+    static const int population_slice_ms = 8;
+    struct population_state {
+        metadb_handle_list tracks;
+        size_t next = 0;      // first track not fed in yet
+        size_t batch = 256;   // tracks per append_population_batch(), adapted to the slice
+        bool stale = false;   // a delta arrived meanwhile; rebuild when done
+        std::unordered_map<grid_item*, std::vector<uint32_t>> joined;  // rows that joined an earlier batch's group
+    };
+    std::unique_ptr<population_state> m_population;
+
+    // v10.0.52: Sort orders of the current model under sort specs other than the one
+    // m_items is in, each with the items' order keys. Switching back to one of them
+    // is a permutation plus key swaps, with no comparisons; deltas keep every stored
+    // order up to date (update_sort_order()). Cleared with each new model.
+    struct sort_order {
+        grid_config::sort_spec spec;
+        std::vector<grid_item*> items;
+        std::vector<std::string> keys;  // order key of items[i] under this mode
+    };
+    std::map<uint32_t, sort_order> m_sort_orders;  // by sort_spec::id()
+    grid_config::sort_spec m_items_sorting;  // order m_items is in
+
+    // v10.0.52: Process-wide model sharing. Every panel subscribes for its lifetime.
+    // Panels with the same model_key (typically a second grid in another layout or a
+    // popup) run the metadb pass and grouping once between them: refresh_items()
+    // copies the model of a subscriber whose model is current, or waits for a
+    // subscriber's build in flight along with it. Items stay per panel - thumbnails
+    // and in-place deltas are panel state - so each panel keeps its own sort, filter
+    // and selection on top of its copy. UI thread only.
+    class shared_model_service {
+    public:
+        static void subscribe(album_grid_instance* panel) {
+            if (panels().empty() && !layout_callback()) layout_callback() = new playlist_layout_callback();
+            panels().insert(panel);
+        }
+        static void unsubscribe(album_grid_instance* panel) {
+            panels().erase(panel);
+            if (panels().empty() && layout_callback()) {
+                delete layout_callback();
+                layout_callback() = nullptr;
+            }
+        }
+
+        // Keys name a playlist by index, and indices move when playlists are created,
+        // reordered or removed. Each such change bumps this revision; keys of the
+        // active playlist follow it to its new index, any other key taken before the
+        // change stops matching.
+        static uint64_t playlist_layout() { return layout_revision(); }
+
+        // A build for key that another panel started and that has seen every delta
+        static std::shared_ptr<model_build> find_build(const model_key& key, const album_grid_instance* except) {
+            for (album_grid_instance* panel : panels()) {
+                if (panel == except || panel->m_is_destroying.load()) continue;
+                const std::shared_ptr<model_build>& build = panel->m_pending_build;
+                if (build && !panel->m_pending_build_stale && !build->cancelled.load() && build->key() == key) return build;
+            }
+            return nullptr;
+        }
+
+        // Another panel whose installed model for key is up to date
+        static album_grid_instance* find_model(const model_key& key, const album_grid_instance* except) {
+            for (album_grid_instance* panel : panels()) {
+                if (panel == except || panel->m_is_destroying.load()) continue;
+                if (panel->m_model_loaded && !panel->m_pending_build && !panel->m_population && panel->m_model_key == key) return panel;
+            }
+            return nullptr;
+        }
+
+    private:
+        class playlist_layout_callback : public playlist_callback_impl_base {
+        public:
+            playlist_layout_callback()
+                : playlist_callback_impl_base(flag_on_playlist_created | flag_on_playlists_reorder | flag_on_playlists_removing | flag_on_playlists_removed) {}
+            void on_playlist_created(t_size p_index, const char*, t_size) override {
+                const t_size active = playlist_manager::get()->get_active_playlist();
+                const t_size before = active == pfc::infinite_size || active == p_index ? pfc::infinite_size : active > p_index ? active - 1 : active;
+                layout_changed(before, active);
+            }
+            void on_playlists_reorder(const t_size* p_order, t_size p_count) override {
+                const t_size active = playlist_manager::get()->get_active_playlist();
+                layout_changed(active < p_count ? p_order[active] : pfc::infinite_size, active);
+            }
+            void on_playlists_removing(const bit_array& p_mask, t_size, t_size) override {
+                const t_size active = playlist_manager::get()->get_active_playlist();
+                m_kept_active = active != pfc::infinite_size && !p_mask.get(active) ? active : pfc::infinite_size;
+            }
+            void on_playlists_removed(const bit_array&, t_size, t_size) override {
+                layout_changed(m_kept_active, playlist_manager::get()->get_active_playlist());
+            }
+        private:
+            t_size m_kept_active = pfc::infinite_size;  // index before the removal, if it survives
+        };
+
+        // before/after: the active playlist's index on either side of the change
+        static void layout_changed(t_size before, t_size after) {
+            const uint64_t old_layout = layout_revision()++;
+            auto rebase = [&](t_size& playlist, uint64_t& layout) {
+                if (layout != old_layout || before == pfc::infinite_size || playlist != before) return;
+                playlist = after;
+                layout = layout_revision();
+            };
+            for (album_grid_instance* panel : panels()) {
+                model_key& key = panel->m_model_key;
+                if (key.view == grid_config::VIEW_PLAYLIST) rebase(key.playlist, key.playlist_layout);
+                model_build* build = panel->m_pending_build.get();
+                if (build && build->view == grid_config::VIEW_PLAYLIST) rebase(build->playlist, build->playlist_layout);
+            }
+        }
+
+        static std::set<album_grid_instance*>& panels() { static std::set<album_grid_instance*> list; return list; }
+        static uint64_t& layout_revision() { static uint64_t revision = 0; return revision; }
+        // Created with the first panel and deleted with the last, never at static
+        // destruction: the SDK base unregisters from playlist_manager in its destructor
+        static playlist_layout_callback*& layout_callback() { static playlist_layout_callback* callback = nullptr; return callback; }
+    };
+
     
 
 public:
@@ -1928,7 +3606,7 @@ public:
 
           m_now_playing_index(-1), m_highlight_now_playing(true),
 
-          m_last_user_scroll(0), m_last_jump_letter(0), m_last_jump_index(-1), m_last_scroll_update(0) {
+          m_last_user_scroll(0), m_last_scroll_update(0) {
         m_config.load(config);
 
         
@@ -1942,6 +3620,7 @@ public:
         // Register this instance (but don't set global shutdown)
 
         shutdown_protection::register_instance(this);
+        shared_model_service::subscribe(this);
 
         
 
@@ -1951,7 +3630,11 @@ public:
 
         pm->register_callback(this, playlist_callback::flag_on_items_added | 
                                    playlist_callback::flag_on_items_removed |
-                                   playlist_callback::flag_on_items_reordered);
+                                   playlist_callback::flag_on_items_reordered |
+                                   playlist_callback::flag_on_items_modified |
+                                   playlist_callback::flag_on_items_replaced |
+                                   playlist_callback::flag_on_playlist_switch);
+        m_library_callback = std::make_unique<library_delta_callback>(this);
     }
 
     // Back buffer helpers
@@ -2026,6 +3709,7 @@ public:
             // Unregister this instance
 
             shutdown_protection::unregister_instance(this);
+            shared_model_service::unsubscribe(this);
 
             
 
@@ -2034,6 +3718,7 @@ public:
             static_api_ptr_t<playlist_manager> pm;
 
             pm->unregister_callback(this);
+            m_library_callback.reset();
 
             
 
@@ -2059,7 +3744,12 @@ public:
 
             // Clear data
 
+            detach_pending_build();
+            stop_population();
+            cancel_cache_check();
+            cancel_search_job();
             m_items.clear();
+            m_snapshot.clear();
 
             m_now_playing.release();
 
@@ -2100,6 +3790,7 @@ public:
             }
 
             shutdown_protection::unregister_instance(this);
+            shared_model_service::unsubscribe(this);
 
             
 
@@ -2305,6 +3996,10 @@ public:
         }
         
 
+        // v10.0.52: Paint the cached model while the first rebuild runs
+
+        restore_cached_model();
+
         // Start loading after a short delay
 
         SetTimer(m_hwnd, TIMER_LOAD, 100, NULL);
@@ -2405,6 +4100,10 @@ public:
 
                 case WM_COMMAND: return instance->on_command(LOWORD(wp), HIWORD(wp));
                 case WM_APP_THUMBNAIL_READY: return instance->on_thumbnail_ready(reinterpret_cast<ThumbnailResult*>(lp));
+                case WM_APP_MODEL_READY: return instance->on_model_ready(wp);
+                case WM_APP_SEARCH_READY: return instance->on_search_ready(wp);
+                case WM_APP_CACHE_READY: return instance->on_cache_ready();
+                case WM_APP_CACHE_CHECKED: return instance->on_cache_checked(wp);
                 case WM_APP + 101:
                     instance->m_invalidate_pending.store(false);
                     InvalidateRect(hwnd, NULL, FALSE);
@@ -2422,6 +4121,7 @@ public:
                         // Unregister this instance
 
                         shutdown_protection::unregister_instance(instance);
+                        shared_model_service::unsubscribe(instance);
 
                         
 
@@ -2436,6 +4136,7 @@ public:
                             static_api_ptr_t<playlist_manager> pm;
 
                             pm->unregister_callback(instance);
+                            instance->m_library_callback.reset();
 
                         } catch(...) {
 
@@ -2467,7 +4168,12 @@ public:
 
                         try {
 
+                            instance->detach_pending_build();
+                            instance->stop_population();
+                            instance->cancel_cache_check();
+                            instance->cancel_search_job();
                             instance->m_items.clear();
+                            instance->m_snapshot.clear();
 
                             instance->m_now_playing.release();
 
@@ -2539,6 +4245,8 @@ public:
 
             }
 
+        } else if (timer_id == TIMER_POPULATE) {
+            populate_slice();
         } else if (timer_id == TIMER_NOW_PLAYING) {
 
             // Check for now playing changes
@@ -2687,7 +4395,9 @@ public:
 
         } else if (key == VK_F5) {
 
-            refresh_items();
+            // v10.0.52: A manual refresh re-reads artwork too
+            thumbnail_cache::forget_art();
+            refresh_items(false);
 
             return 0;
 
@@ -3719,1121 +5429,1192 @@ public:
 
     
 
-    void refresh_items() {
-
-        // Begin a new generation and purge cache entries for old items
-
-        m_items_generation.fetch_add(1);
-
-
-
-        // Remove thumbnails for existing items from the global cache to avoid
-
-        // dangling pointers after the item list is rebuilt (e.g. on grouping change)
-
-        if (!m_items.empty()) {
-
-            for (auto& it : m_items) {
-
-                if (it && it->thumbnail) {
-                    thumbnail_cache::remove_thumbnail(it->thumbnail.get());
-                    // Proactively clear bitmap to release memory sooner
-
-                    it->thumbnail->clear();
-
-                }
-
+    // reuse_peer_model = false forces a rebuild from the live track list, for when
+    // this panel's own deltas stopped adding up (other panels may be in the same state)
+    void refresh_items(bool reuse_peer_model = true) {
+        // v10.0.52: Only the track list is read here (the playlist and library APIs are
+        // main thread only); the rest of the rebuild happens on model_pool()
+        detach_pending_build();
+        stop_population();
+        cancel_cache_check();
+        model_key key;
+        key.view = m_config.view;
+        key.grouping = m_config.grouping;
+        t_size active = pfc::infinite_size;
+        if (m_config.view == grid_config::VIEW_PLAYLIST) {
+            active = playlist_manager::get()->get_active_playlist();
+            key.playlist = active;
+            key.playlist_layout = shared_model_service::playlist_layout();
+        }
+        if (reuse_peer_model && share_peer_model(key)) return;
+        // v10.0.52: A model cache being read is checked once it is there, a restored
+        // one against the live library instead of being rebuilt
+        if (m_hwnd && m_config.view == grid_config::VIEW_LIBRARY) {
+            if (m_cache_restore) {
+                m_refresh_after_restore = true;
+                return;
+            }
+            if (m_restored_model && m_model_key == key) {
+                start_cache_check();
+                return;
             }
-
         }
 
-
-
-        m_items.clear();
-
-        m_selected_indices.clear();
-
-        m_placement_cache_dirty = true;
-
-        
-
-        metadb_handle_list all_items;
-
-        
+        auto build = std::make_shared<model_build>();
+        build->serial = next_build_serial();
+        build->view = key.view;
+        build->grouping = key.grouping;
+        build->sorting = m_config.sorting;
+        build->playlist = key.playlist;
+        build->playlist_layout = key.playlist_layout;
+        if (m_config.view == grid_config::VIEW_LIBRARY) get_model_cache_path(build->cache_path);
+        metadb_handle_list& all_items = build->snapshot.handles;
 
         // Get items based on view mode
-
         if (m_config.view == grid_config::VIEW_PLAYLIST) {
-
             // Get items from current playlist
-
-            auto pm = playlist_manager::get();
-
-            t_size active = pm->get_active_playlist();
-
             if (active != pfc::infinite_size) {
-
-                pm->playlist_get_all_items(active, all_items);
-
+                playlist_manager::get()->playlist_get_all_items(active, all_items);
             }
-
         } else {
-
             // Get items from media library
-
             auto lib = library_manager::get();
-
             lib->get_all_items(all_items);
-
         }
 
-        
-
-        // Group items based on mode
-
-        std::map<pfc::string8, std::unique_ptr<grid_item>> item_map;
-
-        
-
-        for (t_size i = 0; i < all_items.get_count(); i++) {
-
-            try {
-
-                auto handle = all_items[i];
-
-                
-
-                // Add null check for handle (v10.0.4 crash fix)
+        // Nothing current on screen (first load, or the view or grouping changed):
+        // stream the first screen in rather than show an empty or wrong grid until the
+        // build lands. A model cache still being read will show something sooner.
+        if (m_hwnd && ((m_items.empty() && !m_cache_restore) || (m_model_loaded && !(m_model_key == key)))) {
+            start_population(key, all_items);
+            if (!m_population) return;  // finished within the first slice
+        }
 
-                if (!handle.is_valid()) {
+        m_pending_build = build;
+        m_pending_build_stale = false;
+        HWND hwnd = m_hwnd;
+        if (!hwnd) {
+            // No window to post to yet - build in place
+            build_model(*build);
+            on_model_ready(build->serial);
+            return;
+        }
+        build->notify.push_back(hwnd);
+        model_pool().submit([build]() {
+            build_model(*build);
+            {
+                std::lock_guard<std::mutex> lock(build->notify_sync);
+                build->posted = true;
+                if (build->ready.load()) {
+                    for (HWND target : build->notify) {
+                        if (IsWindow(target)) PostMessage(target, WM_APP_MODEL_READY, (WPARAM)build->serial, 0);
+                    }
+                }
+            }
+            if (!build->cache_image.empty()) {
+                write_model_cache(build->cache_path, build->cache_image);
+                std::vector<char>().swap(build->cache_image);
+            }
+        });
+    }
 
-                    console::print("[Album Art Grid v10.0.4] Warning: Null handle encountered at index ", i);
+    // v10.0.52: Takes the model from another panel showing the same key - a copy of
+    // its current model, or a place in the build it is waiting for
+    bool share_peer_model(const model_key& key) {
+        if (album_grid_instance* peer = shared_model_service::find_model(key, this)) {
+            std::vector<std::unique_ptr<grid_item>> items;
+            track_snapshot snapshot;
+            clone_model(peer->m_items, peer->m_snapshot, items, snapshot);
+            install_model(std::move(items), std::move(snapshot), peer->m_items_sorting, key, &peer->m_playlist_rows);
+            return true;
+        }
+        if (!m_hwnd) return false;
+        std::shared_ptr<model_build> build = shared_model_service::find_build(key, this);
+        if (!build) return false;
+        build->consumers++;
+        m_pending_build = build;
+        m_pending_build_stale = false;
+        std::lock_guard<std::mutex> lock(build->notify_sync);
+        if (!build->posted) {
+            build->notify.push_back(m_hwnd);
+        } else if (build->ready.load()) {
+            PostMessage(m_hwnd, WM_APP_MODEL_READY, (WPARAM)build->serial, 0);
+        }
+        return true;
+    }
 
-                    continue;
-
-                }
-
-                
-
-                pfc::string8 key;
-
-                pfc::string8 display_name;
-
-            
-
-            if (m_config.grouping == grid_config::GROUP_BY_FOLDER) {
-
-                // Group by folder - but check metadata first for multi-disc albums
-
-                bool got_from_metadata = false;
-
-                
-
-                // First try to get album info from metadata
-
-                // IMPORTANT: Wrap in try-catch to handle problematic paths
-
-                try {
-
-                    file_info_impl info;
-
-                    if (handle->get_info(info)) {
-
-                        const char* album = info.meta_get("ALBUM", 0);
-
-                        const char* album_artist = info.meta_get("ALBUM ARTIST", 0);
-
-                        if (!album_artist || !album_artist[0]) {
-
-                            album_artist = info.meta_get("ARTIST", 0);
-
-                        }
-
-                        
-
-                        // If we have album metadata, use it
-
-                        if (album && album[0]) {
-
-                            if (album_artist && album_artist[0]) {
-
-                                key << album_artist << " - " << album;
-
-                                display_name = album;
-
-                            } else {
-
-                                key = album;
-
-                                display_name = album;
-
-                            }
-
-                            got_from_metadata = true;
-
-                        }
-
-                    }
-
-                } catch (...) {
-
-                    // If metadata extraction fails, fall back to folder name
-
-                    console::print("[Album Art Grid v10.0.4] Warning: Failed to get metadata for an item, using folder name");
-
-                }
-
-                
-
-                // Fall back to folder name if no metadata or if metadata extraction failed
-
-                if (!got_from_metadata) {
-
-                    try {
-
-                        pfc::string8 path = handle->get_path();
-                        pfc::string8 root_path, root_name;
-                        if (try_get_album_root_folder_from_file_path(path.c_str(), root_path, root_name)) {
-                            key = root_name;
-                            display_name = root_name;
-                        } else {
-
-                        const char* last_slash = strrchr(path.c_str(), '\\');
-
-                        if (!last_slash) last_slash = strrchr(path.c_str(), '/');
-
-                    
-
-                        if (last_slash && last_slash > path.c_str()) {
-
-                            const char* start = path.c_str();
-
-                            const char* second_last = last_slash - 1;
-
-                            while (second_last > start && *second_last != '\\' && *second_last != '/') {
-
-                                second_last--;
-
-                            }
-
-                            if (*second_last == '\\' || *second_last == '/') {
-
-                                second_last++;
-
-                            }
-
-                            key.set_string(second_last, last_slash - second_last);
-
-                            display_name = key;
-
-                        }
-                        }
-
-                    } catch (...) {
-
-                        // If even path extraction fails, use a default
-
-                        console::print("[Album Art Grid v10.0.4] Warning: Failed to process path for an item");
-
-                        key = "Unknown";
-
-                        display_name = key;
-
-                    }
-
-                }
-
-                
-
-                if (key.is_empty()) {
-
-                    key = "Unknown Folder";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_ALBUM) {
-
-                // Group by album - use titleformat for better results
-
-                static_api_ptr_t<titleformat_compiler> compiler;
-
-                titleformat_object::ptr script;
-
-                compiler->compile_safe(script, "[%album artist%]|[%artist%]|[%album%]");
-
-                
-
-                pfc::string8 formatted;
-
-                handle->format_title(NULL, formatted, script, NULL);
-
-                
-
-                // Parse the formatted result
-
-                pfc::list_t<pfc::string8> parts;
-
-                pfc::splitStringSimple_toList(parts, "|", formatted);
-
-                
-
-                pfc::string8 album_artist, artist, album;
-
-                if (parts.get_count() > 0 && !parts[0].is_empty()) album_artist = parts[0];
-
-                if (parts.get_count() > 1 && !parts[1].is_empty()) artist = parts[1];
-
-                if (parts.get_count() > 2 && !parts[2].is_empty()) album = parts[2];
-
-                
-
-                if (!album.is_empty()) {
-
-                    // Use album artist if available, otherwise use artist
-
-                    pfc::string8 primary_artist = !album_artist.is_empty() ? album_artist : artist;
-
-                    
-
-                    if (!primary_artist.is_empty()) {
-
-                        key << primary_artist << " - " << album;
-
-                        display_name = album;
-
-                    } else {
-
-                        key = album;
-
-                        display_name = album;
-
-                    }
-
-                } else {
-
-                    key = "Unknown Album";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_ARTIST) {
-
-                // Group by artist
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* artist = info.meta_get("ARTIST", 0);
-
-                    if (!artist || !artist[0]) artist = info.meta_get("ALBUM ARTIST", 0);
-
-                    if (artist && artist[0]) {
-
-                        key = artist;
-
-                        display_name = artist;
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Unknown Artist";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_ARTIST_ALBUM) {
-
-                // Group by artist/album combination
-
-                static_api_ptr_t<titleformat_compiler> compiler;
-
-                titleformat_object::ptr script;
-
-                compiler->compile_safe(script, "[%album artist%]|[%artist%]|[%album%]");
-
-                
-
-                pfc::string8 formatted;
-
-                handle->format_title(NULL, formatted, script, NULL);
-
-                
-
-                pfc::list_t<pfc::string8> parts;
-
-                pfc::splitStringSimple_toList(parts, "|", formatted);
-
-                
-
-                pfc::string8 album_artist, artist, album;
-
-                if (parts.get_count() > 0 && !parts[0].is_empty()) album_artist = parts[0];
-
-                if (parts.get_count() > 1 && !parts[1].is_empty()) artist = parts[1];
-
-                if (parts.get_count() > 2 && !parts[2].is_empty()) album = parts[2];
-
-                
-
-                pfc::string8 primary_artist = !album_artist.is_empty() ? album_artist : artist;
-
-                
-
-                if (!primary_artist.is_empty() && !album.is_empty()) {
-
-                    key << primary_artist << " - " << album;
-
-                    display_name << primary_artist << " - " << album;
-
-                } else if (!primary_artist.is_empty()) {
-
-                    key = primary_artist;
-
-                    display_name = primary_artist;
-
-                } else if (!album.is_empty()) {
-
-                    key = album;
-
-                    display_name = album;
-
-                } else {
-
-                    key = "Unknown";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_GENRE) {
-
-                // Group by genre
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* genre = info.meta_get("GENRE", 0);
-
-                    if (genre && genre[0]) {
-
-                        key = genre;
-
-                        display_name = genre;
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Unknown Genre";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_YEAR) {
-
-                // Group by year
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* date = info.meta_get("DATE", 0);
-
-                    if (!date || !date[0]) date = info.meta_get("YEAR", 0);
-
-                    if (date && date[0]) {
-
-                        // Extract year from date (might be YYYY-MM-DD or just YYYY)
-
-                        pfc::string8 year;
-
-                        if (strlen(date) >= 4) {
-
-                            year.set_string(date, 4);
-
-                            key = year;
-
-                            display_name = year;
-
-                        }
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Unknown Year";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_LABEL) {
-
-                // Group by record label
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* label = info.meta_get("LABEL", 0);
-
-                    if (!label || !label[0]) label = info.meta_get("PUBLISHER", 0);
-
-                    if (label && label[0]) {
-
-                        key = label;
-
-                        display_name = label;
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Unknown Label";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_COMPOSER) {
-
-                // Group by composer
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* composer = info.meta_get("COMPOSER", 0);
-
-                    if (composer && composer[0]) {
-
-                        key = composer;
-
-                        display_name = composer;
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Unknown Composer";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_PERFORMER) {
-
-                // Group by performer
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* performer = info.meta_get("PERFORMER", 0);
-
-                    if (!performer || !performer[0]) performer = info.meta_get("ARTIST", 0);
-
-                    if (performer && performer[0]) {
-
-                        key = performer;
-
-                        display_name = performer;
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Unknown Performer";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_ALBUM_ARTIST) {
-
-                // Group specifically by album artist
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* album_artist = info.meta_get("ALBUM ARTIST", 0);
-
-                    if (!album_artist || !album_artist[0]) album_artist = info.meta_get("ALBUMARTIST", 0);
-
-                    if (!album_artist || !album_artist[0]) album_artist = info.meta_get("ARTIST", 0);
-
-                    if (album_artist && album_artist[0]) {
-
-                        key = album_artist;
-
-                        display_name = album_artist;
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Unknown Album Artist";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_DIRECTORY) {
-
-                // Group by parent directory name (not full path)
-
-                pfc::string8 path = handle->get_path();
-                pfc::string8 root_path, root_name;
-                if (try_get_album_root_folder_from_file_path(path.c_str(), root_path, root_name)) {
-                    key = root_name;
-                    display_name = key;
-                } else {
-
-                const char* last_slash = strrchr(path.c_str(), '\\');
-
-                if (!last_slash) last_slash = strrchr(path.c_str(), '/');
-
-                if (last_slash && last_slash != path.c_str()) {
-
-                    const char* start = path.c_str();
-
-                    const char* end = last_slash;
-
-                    // Find the second-to-last slash
-
-                    const char* prev_slash = nullptr;
-
-                    for (const char* p = start; p < end; p++) {
-
-                        if (*p == '\\' || *p == '/') {
-
-                            prev_slash = p;
-
-                        }
-
-                    }
-
-                    if (prev_slash) {
-
-                        key.set_string(prev_slash + 1, end - prev_slash - 1);
-
-                        display_name = key;
-
-                    }
-
-                }
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Root Directory";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_COMMENT) {
-
-                // Group by comment field
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* comment = info.meta_get("COMMENT", 0);
-
-                    if (comment && comment[0]) {
-
-                        // Truncate long comments for grouping
-
-                        if (strlen(comment) > 50) {
-
-                            key.set_string(comment, 50);
-
-                            key << "...";
-
-                            display_name = key;
-
-                        } else {
-
-                            key = comment;
-
-                            display_name = comment;
-
-                        }
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "No Comment";
-
-                    display_name = key;
-
-                }
-
-            } else if (m_config.grouping == grid_config::GROUP_BY_RATING) {
-
-                // Group by rating
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* rating = info.meta_get("RATING", 0);
-
-                    if (rating && rating[0]) {
-
-                        int rating_val = atoi(rating);
-
-                        if (rating_val > 0) {
-
-                            key << rating_val << " Stars";
-
-                            display_name = key;
-
-                        }
-
-                    }
-
-                }
-
-                if (key.is_empty()) {
-
-                    key = "Unrated";
-
-                    display_name = key;
-
-                }
-
-            }
-
-            
-
-            if (item_map.find(key) == item_map.end()) {
-
-                auto item = std::make_unique<grid_item>();
-
-                item->display_name = display_name;
-
-                item->sort_key = key;
-
-                item->path = handle->get_path();
-                item->representative_track = handle;
-
-                
-
-                // v10.0.4: Always extract and store the actual folder name
-
-                pfc::string8 full_path = handle->get_path();
-                pfc::string8 root_folder_path, root_folder_name;
-                if (try_get_album_root_folder_from_file_path(full_path.c_str(), root_folder_path, root_folder_name)) {
-                    // Multi-disc folder layouts (CD1/CD2): treat the album root as the folder identity
-                    item->folder_name = root_folder_name;
-                    item->path = root_folder_path;
-                } else {
-
-                const char* last_slash = strrchr(full_path.c_str(), '\\');
-
-                if (!last_slash) last_slash = strrchr(full_path.c_str(), '/');
-
-                if (last_slash && last_slash > full_path.c_str()) {
-
-                    const char* start = full_path.c_str();
-
-                    const char* second_last = last_slash - 1;
-
-                    while (second_last > start && *second_last != '\\' && *second_last != '/') {
-
-                        second_last--;
-
-                    }
-
-                    if (*second_last == '\\' || *second_last == '/') {
-
-                        second_last++;
-
-                    }
-
-                    item->folder_name.set_string(second_last, last_slash - second_last);
-
-                } else {
-
-                    item->folder_name = "Root";
-
-                }
-                }
-
-                
-
-                // Get file date and size
-
-                t_filestats stats = handle->get_filestats();
-
-                item->newest_date = stats.m_timestamp;
-
-                item->total_size = stats.m_size;
-
-                
-
-                // Get metadata for sorting
-
-                file_info_impl info;
-
-                if (handle->get_info(info)) {
-
-                    const char* artist = info.meta_get("ARTIST", 0);
-
-                    if (!artist || !artist[0]) artist = info.meta_get("ALBUM ARTIST", 0);
-
-                    if (artist) item->artist = artist;
-
-                    
-
-                    const char* album = info.meta_get("ALBUM", 0);
-
-                    if (album) item->album = album;
-
-                    
-
-                    const char* genre = info.meta_get("GENRE", 0);
-
-                    if (genre) item->genre = genre;
-
-                    
-
-                    const char* date = info.meta_get("DATE", 0);
-
-                    if (!date || !date[0]) date = info.meta_get("YEAR", 0);
-
-                    if (date && strlen(date) >= 4) {
-
-                        item->year.set_string(date, 4);
-
-                    }
-
-                    
-
-                    const char* rating = info.meta_get("RATING", 0);
-
-                    if (rating) item->rating = atoi(rating);
-
-
-
-                    uint32_t release_key = extract_release_date_from_info(info);
-
-
-
-                    if (release_key != 0) { item->release_date_key = release_key; }
-
-                }
-
-                
-
-                item_map[key] = std::move(item);
-
-            }
-
-            
-
-            item_map[key]->tracks.add_item(handle);
-            add_disc_to_item(*item_map[key], handle);
-            update_representative_track(*item_map[key], handle);
-
-            
-
-            file_info_impl release_info;
-
-            if (handle->get_info(release_info)) {
-
-                uint32_t release_key = extract_release_date_from_info(release_info);
-
-                if (release_key != 0 && release_key > item_map[key]->release_date_key) {
-
-                    item_map[key]->release_date_key = release_key;
+    // v10.0.52: Leaves the build in flight; it is only cancelled if no other panel
+    // waits for it
+    void detach_pending_build() {
+        if (!m_pending_build) return;
+        if (--m_pending_build->consumers == 0) m_pending_build->cancelled.store(true);
+        m_pending_build.reset();
+    }
+
+    // v10.0.52: Starts progressive population of tracks into an empty model for key
+    void start_population(const model_key& key, const metadb_handle_list& tracks) {
+        install_model(std::vector<std::unique_ptr<grid_item>>(), track_snapshot(), m_config.sorting, key);
+        m_population = std::make_unique<population_state>();
+        m_population->tracks = tracks;
+        SetTimer(m_hwnd, TIMER_POPULATE, USER_TIMER_MINIMUM, NULL);
+        populate_slice();  // the first groups go out with the next paint
+    }
+
+    void stop_population() {
+        if (!m_population) return;
+        if (m_hwnd) KillTimer(m_hwnd, TIMER_POPULATE);
+        m_population.reset();
+    }
+
+    // One slice: batches of tracks until the slice budget is spent. The batch size
+    // follows the measured cost, so the first slice already fills the first screen
+    // and later ones stay within budget.
+    void populate_slice() {
+        if (!m_population || m_is_destroying.load()) return;
+        population_state& population = *m_population;
+        const auto budget = std::chrono::milliseconds(population_slice_ms);
+        const auto slice_start = std::chrono::steady_clock::now();
+        const size_t total = population.tracks.get_count();
+        while (population.next < total) {
+            const auto batch_start = std::chrono::steady_clock::now();
+            const size_t count = std::min(population.batch, total - population.next);
+            metadb_handle_list batch;
+            batch.prealloc(count);
+            for (size_t i = 0; i < count; i++) batch.add_item(population.tracks[population.next + i]);
+            population.next += count;
+
+            const size_t first_new_row = m_snapshot.append(batch);
+            std::vector<uint32_t> rows_to_key(count);
+            for (size_t i = 0; i < count; i++) rows_to_key[i] = (uint32_t)(first_new_row + i);
+            if (m_config.view == grid_config::VIEW_PLAYLIST) {
+                m_playlist_rows.insert(m_playlist_rows.end(), rows_to_key.begin(), rows_to_key.end());
+            }
+            append_population_batch(rows_to_key, first_new_row);
 
+            const auto now = std::chrono::steady_clock::now();
+            const auto took = now - batch_start;
+            if (took > budget / 2 && population.batch > 64) population.batch /= 2;
+            else if (took < budget / 8 && population.batch < 16384) population.batch *= 2;
+            if (now - slice_start >= budget) break;
+        }
+        // Items were only appended, so display indices (selection, filter) still hold
+        { insync(g_count_sync); g_album_count = m_items.size(); }
+        m_placement_cache_dirty = true;
+        m_jump_index.clear();
+        update_scrollbar();
+        request_invalidate();
+        load_visible_artwork();
+        if (population.next >= total) {
+            finish_population();
+        } else if (m_pending_build && m_items.size() >= screen_item_capacity()) {
+            stop_population();  // the rest comes with the build
+        }
+    }
+
+    // Items that fit in the client area at the current column count, plus a row
+    size_t screen_item_capacity() const {
+        RECT rc = {};
+        if (m_hwnd) GetClientRect(m_hwnd, &rc);
+        const int cell = std::max(1, m_item_size);
+        const size_t rows = (size_t)std::max(0L, (long)rc.bottom) / (size_t)cell + 2;
+        return rows * (size_t)std::max(1, m_config.columns);
+    }
+
+    // v10.0.52: Groups the batch's rows. New groups go to the end of m_items, and into
+    // the filter if they match; rows joining a group from an earlier batch are noted
+    // in population.joined and folded in by finish_population().
+    void append_population_batch(const std::vector<uint32_t>& rows_to_key, size_t first_new_row) {
+        std::unordered_set<grid_item*> touched;
+        std::unordered_map<grid_item*, std::vector<uint32_t>> joined;
+        std::vector<std::unique_ptr<grid_item>> created;
+        group_delta_rows(rows_to_key, 0, touched, joined, created);
+        m_snapshot.index_rows(first_new_row, m_snapshot.get_count());
+        for (auto& entry : joined) {
+            std::vector<uint32_t>& rows = m_population->joined[entry.first];
+            rows.insert(rows.end(), entry.second.begin(), entry.second.end());
+        }
+        const bool searching = !m_search_text.is_empty();
+        for (auto& item : created) {
+            if (searching && grid_item_matches_search(*item, m_search_folded)) m_filtered_indices.push_back((int)m_items.size());
+            m_items.push_back(std::move(item));
+        }
+    }
+
+    // Folds the rows that joined earlier groups, then puts the appended items in order
+    // once, keeping the selection on the same items; the library model also goes to
+    // the model cache like a built one
+    void finish_population() {
+        // Done before the build: it is not needed, but deltas it took stand
+        const bool stale = m_population->stale || (m_pending_build && m_pending_build_stale);
+        std::unordered_map<grid_item*, std::vector<uint32_t>> joined = std::move(m_population->joined);
+        stop_population();
+        detach_pending_build();
+        m_pending_build_stale = false;
+        // Playlist groups take their rows in playlist order, as in apply_row_delta()
+        const bool playlist_order = (m_config.view == grid_config::VIEW_PLAYLIST);
+        std::unordered_map<grid_item*, std::vector<uint32_t>> playlist_group_rows;
+        if (playlist_order && !joined.empty()) {
+            for (uint32_t row : m_playlist_rows) {
+                if (row == no_playlist_row) continue;
+                grid_item* owner = m_snapshot.owner[row];
+                if (owner && joined.count(owner)) playlist_group_rows[owner].push_back(row);
+            }
+        }
+        for (auto& entry : joined) {
+            grid_item* item = entry.first;
+            std::vector<uint32_t> rows;
+            if (playlist_order) {
+                rows.swap(playlist_group_rows[item]);
+            } else {
+                rows.reserve(item->tracks.get_count() + entry.second.size());
+                for (t_size j = 0; j < item->tracks.get_count(); j++) {
+                    int row = m_snapshot.row_of(item->tracks[j]);
+                    if (row >= 0 && m_snapshot.owner[row] == item) rows.push_back((uint32_t)row);
                 }
+                rows.insert(rows.end(), entry.second.begin(), entry.second.end());
+            }
+            metadb_handle_ptr old_representative = item->representative_track;
+            fold_group_rows(*item, m_snapshot, rows);
+            if (item->representative_track != old_representative) {
+                thumbnail_cache::remove_thumbnail(item->thumbnail.get());
+                item->thumbnail = std::make_shared<thumbnail_data>();
+            }
+        }
 
+        std::vector<grid_item*> selected_items;
+        for (int index : m_selected_indices) {
+            if (auto* item = get_item_at(index)) selected_items.push_back(item);
+        }
+        sort_grid_items(m_items, m_items_sorting);
+        m_sort_orders.clear();  // stored while populating, so missing the later items
+        m_filtered_indices.clear();
+        if (!m_search_text.is_empty()) apply_filter();
+        m_selected_indices.clear();
+        if (!selected_items.empty()) {
+            std::unordered_map<grid_item*, int> display_index;
+            for (size_t i = 0; i < get_item_count(); i++) display_index.emplace(get_item_at((int)i), (int)i);
+            for (grid_item* item : selected_items) {
+                auto found = display_index.find(item);
+                if (found != display_index.end()) m_selected_indices.insert(found->second);
             }
-
-            
-
-            // Track newest date and total size
-
-            t_filestats stats = handle->get_filestats();
-
-            if (stats.m_timestamp > item_map[key]->newest_date) {
-
-                item_map[key]->newest_date = stats.m_timestamp;
-
+        }
+        m_now_playing_index = m_now_playing.is_valid() ? find_track_album(m_now_playing) : -1;
+        m_placement_cache_dirty = true;
+        m_layout_cache.invalidate();
+        m_jump_index.clear();
+        m_context_menu_cache.invalidate();
+        { insync(g_count_sync); g_album_count = m_items.size(); }
+
+        std::wstring cache_path;
+        if (m_config.view == grid_config::VIEW_LIBRARY && get_model_cache_path(cache_path)) {
+            // m_items is in m_items_sorting order, which is what a restore must be told
+            try {
+                auto source = std::make_shared<model_cache_source>();
+                capture_model_cache_source(m_items, m_snapshot, m_config.view, m_config.grouping, m_items_sorting, *source);
+                model_pool().submit([cache_path, source]() {
+                    try {
+                        write_model_cache(cache_path, serialize_model(*source));
+                    } catch (...) {
+                    }
+                });
+            } catch (...) {
             }
-
-            item_map[key]->total_size += stats.m_size;
-
+        }
+        update_scrollbar();
+        request_invalidate();
+        if (m_hwnd) SetTimer(m_hwnd, TIMER_PROGRESSIVE, 50, NULL);
+        if (stale) refresh_items();
+    }
+
+    // v10.0.52: Worker side of refresh_items(): one metadata pass over the snapshot,
+    // sharded parallel grouping with a compile-once key extractor per mode, then the
+    // sort. Touches nothing but the build.
+    static void build_model(model_build& build) {
+        if (build.cancelled.load()) return;
+        build.snapshot.resize_columns();
+        group_items(build.snapshot, build.grouping, build.items, &build.cancelled);
+        if (build.cancelled.load()) return;
+        sort_grid_items(build.items, build.sorting);
+        if (!build.cache_path.empty()) {
+            try {
+                model_cache_source source;
+                capture_model_cache_source(build.items, build.snapshot, build.view, build.grouping, build.sorting, source);
+                build.cache_image = serialize_model(source);
             } catch (...) {
-
-                // If processing of one item fails, log it and continue with the next
-
-                console::printf("[Album Art Grid v10.0.3] Warning: Failed to process item %u of %u, skipping", 
-
-                               (unsigned)i + 1, (unsigned)all_items.get_count());
-
-                continue;
-
+                build.cache_image.clear();
             }
+        }
+        build.ready.store(true);
+    }
 
+    // v10.0.52: UI side - swaps the finished build in for the current model
+    LRESULT on_model_ready(WPARAM serial) {
+        if (m_is_destroying.load()) return 0;
+        if (!m_pending_build || m_pending_build->serial != (uint64_t)serial || !m_pending_build->ready.load()) return 0;
+        std::shared_ptr<model_build> build = std::move(m_pending_build);
+        stop_population();  // the build replaces a partial model
+        const bool stale = m_pending_build_stale;
+        m_pending_build_stale = false;
+        const bool last_consumer = --build->consumers == 0;
+        if (build->view != m_config.view || build->grouping != m_config.grouping) {
+            // Configuration changed while it was building
+            refresh_items();
+            return 0;
         }
 
-        
+        // Other panels still waiting for this build get the original
+        std::vector<std::unique_ptr<grid_item>> items;
+        track_snapshot snapshot;
+        if (last_consumer) {
+            items = std::move(build->items);
+            snapshot = std::move(build->snapshot);
+        } else {
+            clone_model(build->items, build->snapshot, items, snapshot);
+        }
+        install_model(std::move(items), std::move(snapshot), build->sorting, build->key());
 
-        // Convert map to vector
+        // Deltas that arrived during the build are not in it
+        if (stale) refresh_items();
+        return 0;
+    }
 
-        for (auto& pair : item_map) {
-            if (pair.second) {
-                uint8_t dc = popcount_u32(pair.second->disc_mask);
-                pair.second->disc_count = (dc == 0 ? 1 : dc);
+    // v10.0.52: Swaps a finished model in for the current one. items are ordered by
+    // items_sorting; playlist_rows maps playlist entries to snapshot rows and may be
+    // left out when the rows are still in playlist order.
+    void install_model(std::vector<std::unique_ptr<grid_item>> items, track_snapshot snapshot,
+                       const grid_config::sort_spec& items_sorting, const model_key& key,
+                       const std::vector<uint32_t>* playlist_rows = nullptr) {
+        // Begin a new generation. Old thumbnails stay in the cache (it holds its own
+        // references) so the new items can re-attach them - see attach_known_artwork()
+        m_items_generation.fetch_add(1);
+        cancel_cache_check();
+        m_restored_model = false;
+
+        m_items = std::move(items);
+        m_snapshot = std::move(snapshot);
+        m_items_sorting = items_sorting;
+        m_sort_orders.clear();
+        m_jump_index.clear();
+        reset_search_index();
+        m_group_index.clear();
+        m_group_index_ready = false;
+        m_selected_indices.clear();
+        m_placement_cache_dirty = true;
+        m_model_loaded = true;
+        m_model_key = key;
+        m_playlist_rows.clear();
+        if (m_config.view == grid_config::VIEW_PLAYLIST && playlist_rows) {
+            m_playlist_rows = *playlist_rows;
+        } else if (m_config.view == grid_config::VIEW_PLAYLIST) {
+            m_playlist_rows.resize(m_snapshot.get_count());
+            for (size_t row = 0; row < m_playlist_rows.size(); row++) {
+                m_playlist_rows[row] = m_snapshot.owner[row] ? (uint32_t)row : no_playlist_row;
             }
-
-            m_items.push_back(std::move(pair.second));
-
         }
 
-        
-
-        // Sort items
-
-        sort_items();
-
-        
+        // Sorting may have changed after the build took its copy
+        if (items_sorting != m_config.sorting) sort_items();
+        // Filter indices refer to the old list
+        if (!m_search_text.is_empty()) apply_filter();
 
         // Update global album count for titleformat fields
-
-        { insync(g_count_sync); g_album_count = m_items.size(); g_is_library_view = (m_config.view != grid_config::VIEW_PLAYLIST); g_last_grouping = (int)m_config.grouping; g_last_sorting = (int)m_config.sorting;
-
+        { insync(g_count_sync); g_album_count = m_items.size(); g_is_library_view = (m_config.view != grid_config::VIEW_PLAYLIST); g_last_grouping = (int)m_config.grouping; g_last_sorting = (int)m_config.sorting.primary();
         }
 
         // Trigger refresh of titleformat (including status bar)
-
         // Just dispatch empty refresh to notify titleformat fields changed
-
         metadb_handle_list dummy;
-
         static_api_ptr_t<metadb_io>()->dispatch_refresh(dummy);
 
-        
-
         // Check for now playing track
-
         check_now_playing();
 
-        
-
         // Update scrollbar and repaint
-
         update_scrollbar();
-
         request_invalidate();
+        if (m_hwnd) SetTimer(m_hwnd, TIMER_PROGRESSIVE, 50, NULL);
+    }
+
+    // v10.0.52: Paints the last library model from the model cache as soon as
+    // model_pool() has read it; the first refresh (TIMER_LOAD) waits for it and then
+    // checks it against the live library (start_cache_check()). Until then cached
+    // items have no snapshot rows, so lookups on them take the live paths, and deltas
+    // are left to the check (m_model_loaded stays false).
+    void restore_cached_model() {
+        if (m_config.view != grid_config::VIEW_LIBRARY || !m_items.empty() || !m_hwnd) return;
+        auto job = std::make_shared<cache_restore>();
+        if (!get_model_cache_path(job->path)) return;
+        job->grouping = m_config.grouping;
+        job->sorting = m_config.sorting;
+        m_cache_restore = job;
+        HWND hwnd = m_hwnd;
+        model_pool().submit([job, hwnd]() {
+            job->loaded.store(read_model_cache(*job, hwnd));
+            if (IsWindow(hwnd)) PostMessage(hwnd, WM_APP_CACHE_READY, 0, 0);
+        });
+    }
+
+    // Worker side of restore_cached_model(); false if the cache does not fit the
+    // panel's view, or the panel went away meanwhile
+    static bool read_model_cache(cache_restore& job, HWND hwnd) {
+        try {
+            mapped_file file(job.path.c_str());
+            albumart_grid::model_cache_view cache;
+            if (!cache.open(file.data(), file.size())) return false;
+            const albumart_grid::model_cache_header& header = cache.header();
+            if (header.view != (int32_t)grid_config::VIEW_LIBRARY || header.grouping != (int32_t)job.grouping) return false;
+            if (!grid_config::sort_spec::from_id((uint32_t)header.sorting, job.sorting)) return false;
+
+            albumart_grid::string_pool& strings = *job.snapshot.strings;
+            auto text = [&](uint32_t offset) { return strings.intern(cache.string(offset)); };
+            auto db = metadb::get();
+            pfc::string8 location;
+            std::vector<std::unique_ptr<grid_item>>& items = job.items;
+            items.reserve(header.item_count);
+            for (uint32_t i = 0; i < header.item_count; i++) {
+                if (i % 256 == 0 && (shutdown_protection::is_shutting_down() || !IsWindow(hwnd))) return false;
+                const albumart_grid::model_cache_item& rec = cache.item(i);
+                auto item = std::make_unique<grid_item>();
+                item->display_name = text(rec.display_name);
+                item->folder_name = text(rec.folder_name);
+                item->sort_key = text(rec.sort_key);
+                item->path = text(rec.path);
+                item->artist = text(rec.artist);
+                item->album = text(rec.album);
+                item->genre = text(rec.genre);
+                item->year = text(rec.year);
+                item->newest_date = rec.newest_date;
+                item->total_size = rec.total_size;
+                item->rating = rec.rating;
+                item->release_date_key = rec.release_date_key;
+                item->disc_mask = rec.disc_mask;
+                item->disc_count = (uint8_t)rec.disc_count;
+                item->tracks.prealloc(rec.track_count);
+                for (uint32_t t = 0; t < rec.track_count; t++) {
+                    const albumart_grid::model_cache_track& track = cache.track(rec.first_track + t);
+                    location = cache.string(track.directory);
+                    location << cache.string(track.file_name);
+                    metadb_handle_ptr handle;
+                    db->handle_create(handle, make_playable_location(location, track.subsong));
+                    item->tracks.add_item(handle);
+                }
+                if (rec.track_count > 0) item->representative_track = item->tracks[rec.representative];
+                items.push_back(std::move(item));
+            }
+        } catch (...) {
+            job.items.clear();
+            return false;
+        }
+        return true;
     }
 
-    
-
-    void sort_items() {
-
-        switch (m_config.sorting) {
-
-            case grid_config::SORT_BY_NAME:
-
-                std::sort(m_items.begin(), m_items.end(), 
-
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
-
-                        return pfc::stricmp_ascii(a->sort_key.c_str(), b->sort_key.c_str()) < 0;
-
-                    });
-
-                break;
-
-            case grid_config::SORT_BY_DATE:
-
-                std::sort(m_items.begin(), m_items.end(), 
-
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
-
-                        return a->newest_date > b->newest_date;
-
-                    });
-
-                break;
-
-            case grid_config::SORT_BY_RELEASE_DATE:
-
-                std::sort(m_items.begin(), m_items.end(), 
-
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
-
-                        if (a->release_date_key == b->release_date_key) {
-
-                            if (a->release_date_key == 0) {
-
-                                return a->newest_date > b->newest_date;
-
-                            }
-
-                            if (a->newest_date == b->newest_date) {
-
-                                return pfc::stricmp_ascii(a->sort_key.c_str(), b->sort_key.c_str()) < 0;
-
-                            }
-
-                            return a->newest_date > b->newest_date;
-
-                        }
-
-                        return a->release_date_key > b->release_date_key;
-
-                    });
-
-                break;
-
-            case grid_config::SORT_BY_TRACK_COUNT:
-
-                std::sort(m_items.begin(), m_items.end(), 
-
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
-
-                        return a->tracks.get_count() > b->tracks.get_count();
-
-                    });
-
-                break;
-
-            case grid_config::SORT_BY_ARTIST:
-
-                std::sort(m_items.begin(), m_items.end(), 
-
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
-
-                        return pfc::stricmp_ascii(a->artist.c_str(), b->artist.c_str()) < 0;
-
-                    });
-
-                break;
-
-            case grid_config::SORT_BY_ALBUM:
-
-                std::sort(m_items.begin(), m_items.end(), 
-
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
-
-                        return pfc::stricmp_ascii(a->album.c_str(), b->album.c_str()) < 0;
-
-                    });
-
-                break;
+    LRESULT on_cache_ready() {
+        std::shared_ptr<cache_restore> job = std::move(m_cache_restore);
+        if (!job) return 0;
+        show_restored_model(*job);
+        // The first refresh waited for the cache; with nothing to show after all, a
+        // panel waiting for a peer's build streams the model in instead
+        if (m_refresh_after_restore || (m_items.empty() && m_pending_build)) {
+            m_refresh_after_restore = false;
+            refresh_items();
+        }
+        return 0;
+    }
 
-            case grid_config::SORT_BY_YEAR:
+    void show_restored_model(cache_restore& job) {
+        if (!job.loaded.load()) return;
+        // A model (or its population) got here first, or the view changed meanwhile
+        if (m_model_loaded || m_population || !m_items.empty()) return;
+        if (m_config.view != grid_config::VIEW_LIBRARY || m_config.grouping != job.grouping) return;
+
+        m_snapshot.clear();
+        m_snapshot.strings = job.snapshot.strings;
+        m_items = std::move(job.items);
+        m_items_sorting = job.sorting;
+        m_restored_model = true;
+        m_model_key = model_key();
+        m_model_key.view = grid_config::VIEW_LIBRARY;
+        m_model_key.grouping = job.grouping;
+        m_sort_orders.clear();
+        m_jump_index.clear();
+        reset_search_index();
+        if (m_items_sorting != m_config.sorting) sort_items();
+        { insync(g_count_sync); g_album_count = m_items.size(); g_is_library_view = true; g_last_grouping = (int)m_config.grouping; g_last_sorting = (int)m_config.sorting.primary(); }
+        m_placement_cache_dirty = true;
+        update_scrollbar();
+        request_invalidate();
+        console::printf("[Album Art Grid v10.0.52] Restored %u albums from the model cache", (unsigned)m_items.size());
+    }
+
+    void start_cache_check() {
+        cancel_cache_check();
+        auto check = std::make_shared<cache_check>();
+        check->serial = next_build_serial();
+        library_manager::get()->get_all_items(check->live);
+        capture_model_cache_source(m_items, m_snapshot, grid_config::VIEW_LIBRARY, m_model_key.grouping, m_items_sorting, check->source);
+        check->items.reserve(m_items.size());
+        for (const auto& item : m_items) check->items.push_back(item.get());
+        m_cache_check = check;
+        HWND hwnd = m_hwnd;
+        model_pool().submit([check, hwnd]() {
+            try {
+                check_cached_model(*check);
+            } catch (...) {
+                check->too_different = true;
+            }
+            if (!check->cancelled.load() && IsWindow(hwnd)) PostMessage(hwnd, WM_APP_CACHE_CHECKED, (WPARAM)check->serial, 0);
+        });
+    }
+
+    void cancel_cache_check() {
+        if (m_cache_check) m_cache_check->cancelled.store(true);
+        m_cache_check.reset();
+        m_cache_check_stale = false;
+    }
+
+    // Folded fields of a restored item that a rebuild could have computed differently
+    static bool same_folded_fields(const grid_item& folded, const model_cache_source::entry& cached) {
+        return folded.folder_name.view() == cached.folder_name.view() && folded.path.view() == cached.path.view() &&
+               folded.artist.view() == cached.artist.view() && folded.album.view() == cached.album.view() &&
+               folded.genre.view() == cached.genre.view() && folded.year.view() == cached.year.view() &&
+               folded.newest_date == cached.newest_date && folded.total_size == cached.total_size &&
+               folded.rating == cached.rating && folded.release_date_key == cached.release_date_key &&
+               folded.disc_mask == cached.disc_mask && folded.disc_count == cached.disc_count &&
+               folded.representative_track == cached.representative_track;
+    }
+
+    // v10.0.52: Worker side of start_cache_check(). The restored tracks become snapshot
+    // rows, item by item; membership is diffed against the live list by handle, then
+    // one metadata pass keys the kept rows (a changed key moves the row) and refolds
+    // every item whose rows all stayed into a scratch item, which must come out as
+    // the cache had it. A diff past a quarter of the library is left to a rebuild.
+    static void check_cached_model(cache_check& check) {
+        track_snapshot& snapshot = check.snapshot;
+        const std::vector<model_cache_source::entry>& entries = check.source.entries;
+        snapshot.strings = check.source.strings;
+        std::vector<uint32_t> first_row(entries.size() + 1, 0);
+        for (size_t g = 0; g < entries.size(); g++) {
+            first_row[g] = (uint32_t)snapshot.handles.get_count();
+            snapshot.handles.add_items(entries[g].tracks);
+            check.row_group.resize(snapshot.handles.get_count(), (uint32_t)g);
+        }
+        first_row[entries.size()] = (uint32_t)snapshot.handles.get_count();
+        snapshot.resize_columns();
+
+        std::unordered_set<const metadb_handle*> cached, live;
+        cached.reserve(snapshot.get_count());
+        for (size_t row = 0; row < snapshot.get_count(); row++) cached.insert(snapshot.handles[row].get_ptr());
+        live.reserve(check.live.get_count());
+        for (t_size i = 0; i < check.live.get_count(); i++) {
+            const metadb_handle_ptr& handle = check.live[i];
+            if (live.insert(handle.get_ptr()).second && !cached.count(handle.get_ptr())) check.added.add_item(handle);
+        }
+        std::vector<char> group_changed(entries.size(), 0);
+        std::vector<uint32_t> kept;
+        kept.reserve(snapshot.get_count());
+        for (size_t row = 0; row < snapshot.get_count(); row++) {
+            if (live.count(snapshot.handles[row].get_ptr())) {
+                kept.push_back((uint32_t)row);
+            } else {
+                check.removed_rows.push_back((uint32_t)row);
+                group_changed[check.row_group[row]] = 1;
+            }
+        }
+        const size_t limit = std::max<size_t>(256, check.live.get_count() / 4);
+        if (check.added.get_count() + check.removed_rows.size() > limit) {
+            check.too_different = true;
+            return;
+        }
+        if (check.cancelled.load()) return;
 
-                std::sort(m_items.begin(), m_items.end(), 
+        with_group_key_extractor(check.source.grouping, [&](const auto& extractor) {
+            std::vector<std::string> keys;
+            key_snapshot_rows(snapshot, extractor, kept, keys);
+            for (size_t i = 0; i < kept.size(); i++) {
+                const uint32_t group = check.row_group[kept[i]];
+                if (keys[i] == entries[group].sort_key.view()) continue;
+                check.moved_rows.push_back(kept[i]);
+                group_changed[group] = 1;
+            }
+        });
+        if (check.moved_rows.size() > limit || check.cancelled.load()) {
+            check.too_different = check.moved_rows.size() > limit;
+            return;
+        }
 
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
+        albumart_grid::parallel_for_chunks(entries.size(), 256, 0, [&](size_t begin, size_t end) {
+            grid_item folded;
+            std::vector<uint32_t> rows;
+            for (size_t g = begin; g < end; g++) {
+                if (group_changed[g] || first_row[g] == first_row[g + 1]) continue;
+                rows.clear();
+                for (uint32_t row = first_row[g]; row < first_row[g + 1]; row++) rows.push_back(row);
+                fold_group_rows(folded, snapshot, rows);
+                if (!same_folded_fields(folded, entries[g])) group_changed[g] = 1;
+            }
+        });
+        for (size_t g = 0; g < entries.size(); g++) {
+            if (group_changed[g]) check.changed.push_back((uint32_t)g);
+        }
+    }
+
+    // v10.0.52: UI side - the restored items become the model, with the check's
+    // differences applied as one delta. A check that took its live list before a
+    // delta arrived is run again.
+    LRESULT on_cache_checked(WPARAM serial) {
+        if (m_is_destroying.load()) return 0;
+        if (!m_cache_check || m_cache_check->serial != (uint64_t)serial) return 0;
+        std::shared_ptr<cache_check> check = std::move(m_cache_check);
+        if (!m_restored_model || m_config.view != grid_config::VIEW_LIBRARY || m_config.grouping != m_model_key.grouping) return 0;
+        if (m_cache_check_stale) {
+            start_cache_check();
+            return 0;
+        }
+        if (check->too_different) {
+            m_restored_model = false;
+            refresh_items();
+            return 0;
+        }
 
-                        // Sort by year descending (newest first)
+        m_snapshot = std::move(check->snapshot);
+        for (size_t row = 0; row < m_snapshot.get_count(); row++) {
+            m_snapshot.owner[row] = check->items[check->row_group[row]];
+        }
+        m_restored_model = false;
+        m_model_loaded = true;
+        m_group_index.clear();
+        m_group_index_ready = false;
+        m_playlist_rows.clear();
+
+        std::unordered_set<grid_item*> touched;
+        for (uint32_t group : check->changed) touched.insert(check->items[group]);
+        for (uint32_t row : check->removed_rows) m_snapshot.kill_row(row);
+        std::vector<uint32_t> rows_to_key = check->moved_rows;
+        const size_t modified_count = rows_to_key.size();
+        const size_t first_new_row = m_snapshot.append(check->added);
+        for (size_t row = first_new_row; row < m_snapshot.get_count(); row++) rows_to_key.push_back((uint32_t)row);
+        apply_row_delta(rows_to_key, modified_count, first_new_row, std::move(touched));
+        console::printf("[Album Art Grid v10.0.52] Checked the cached model: %u tracks added, %u removed, %u albums changed",
+                        (unsigned)check->added.get_count(), (unsigned)check->removed_rows.size(), (unsigned)check->changed.size());
+        return 0;
+    }
 
-                        return pfc::stricmp_ascii(a->year.c_str(), b->year.c_str()) > 0;
+    // v10.0.52: A build in flight took its track list before this delta, so the delta
+    // is folded into a follow-up rebuild instead of the model about to be replaced
+    bool model_accepts_delta() {
+        if (m_cache_check) {
+            m_cache_check_stale = true;
+            return false;
+        }
+        if (m_pending_build) {
+            m_pending_build_stale = true;
+            return false;
+        }
+        if (m_population) {
+            // Tracks not fed in yet would be counted twice
+            m_population->stale = true;
+            return false;
+        }
+        return m_model_loaded;
+    }
+
+    // v10.0.52: Library view - library_callback deltas, matched to rows by handle. A
+    // modified track that had no group yet (e.g. an empty GENRE got filled in) is
+    // handled like an added one.
+    void on_library_delta(const pfc::list_base_const_t<metadb_handle_ptr>* added,
+                          const pfc::list_base_const_t<metadb_handle_ptr>* removed,
+                          const pfc::list_base_const_t<metadb_handle_ptr>* modified) {
+        if (m_config.view != grid_config::VIEW_LIBRARY) return;
+        if (m_is_destroying.load() || !model_accepts_delta()) return;
+
+        std::unordered_set<grid_item*> touched;
+        if (removed) {
+            for (t_size i = 0; i < removed->get_count(); i++) {
+                int row = m_snapshot.row_of(removed->get_item(i));
+                if (row < 0) continue;
+                touched.insert(m_snapshot.owner[row]);
+                m_snapshot.kill_row(row);
+            }
+        }
 
-                    });
+        std::vector<uint32_t> rows_to_key;
+        metadb_handle_list fresh;
+        std::unordered_set<const metadb_handle*> queued;
+        auto queue_new = [&](const metadb_handle_ptr& handle) {
+            if (handle.is_valid() && queued.insert(handle.get_ptr()).second) fresh.add_item(handle);
+        };
+        if (modified) {
+            for (t_size i = 0; i < modified->get_count(); i++) {
+                metadb_handle_ptr handle = modified->get_item(i);
+                int row = m_snapshot.row_of(handle);
+                if (row >= 0) rows_to_key.push_back((uint32_t)row);
+                else queue_new(handle);
+            }
+        }
+        const size_t modified_count = rows_to_key.size();
+        if (added) {
+            for (t_size i = 0; i < added->get_count(); i++) {
+                metadb_handle_ptr handle = added->get_item(i);
+                if (m_snapshot.row_of(handle) < 0) queue_new(handle);
+            }
+        }
+        const size_t first_new_row = m_snapshot.append(fresh);
+        for (size_t row = first_new_row; row < m_snapshot.get_count(); row++) rows_to_key.push_back((uint32_t)row);
 
-                break;
+        apply_row_delta(rows_to_key, modified_count, first_new_row, std::move(touched));
+    }
 
-            case grid_config::SORT_BY_GENRE:
+    // v10.0.52: Playlist view - playlist callbacks, matched to rows by playlist index
+    // through m_playlist_rows. If the two ever disagree on the playlist length the
+    // view falls back to a full refresh.
+    bool playlist_delta_ready() {
+        return m_config.view == grid_config::VIEW_PLAYLIST && !m_is_destroying.load() && model_accepts_delta();
+    }
 
-                std::sort(m_items.begin(), m_items.end(), 
+    void on_playlist_items_added(t_size base, metadb_handle_list_cref items) {
+        if (!playlist_delta_ready()) return;
+        if (base > m_playlist_rows.size()) { refresh_items(false); return; }
 
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
+        const size_t first_new_row = m_snapshot.append(items);
+        std::vector<uint32_t> rows_to_key;
+        rows_to_key.reserve(items.get_count());
+        for (size_t row = first_new_row; row < m_snapshot.get_count(); row++) rows_to_key.push_back((uint32_t)row);
+        m_playlist_rows.insert(m_playlist_rows.begin() + base, rows_to_key.begin(), rows_to_key.end());
 
-                        return pfc::stricmp_ascii(a->genre.c_str(), b->genre.c_str()) < 0;
+        apply_row_delta(rows_to_key, 0, first_new_row, {});
+    }
 
-                    });
+    void on_playlist_items_removed(const bit_array& mask, t_size old_count) {
+        if (!playlist_delta_ready()) return;
+        if (old_count != m_playlist_rows.size()) { refresh_items(false); return; }
 
-                break;
+        std::unordered_set<grid_item*> touched;
+        size_t kept = 0;
+        for (size_t i = 0; i < old_count; i++) {
+            const uint32_t row = m_playlist_rows[i];
+            if (!mask.get(i)) {
+                m_playlist_rows[kept++] = row;
+            } else if (row != no_playlist_row) {
+                touched.insert(m_snapshot.owner[row]);
+                m_snapshot.kill_row(row);
+            }
+        }
+        m_playlist_rows.resize(kept);
 
-            case grid_config::SORT_BY_PATH:
+        apply_row_delta({}, 0, m_snapshot.get_count(), std::move(touched));
+    }
 
-                std::sort(m_items.begin(), m_items.end(), 
+    // Membership does not change, but groups whose tracks moved are refolded since
+    // their first track (display name, folder, ...) may be a different one now
+    void on_playlist_items_reordered(const t_size* order, t_size count) {
+        if (!playlist_delta_ready()) return;
+        if (count != m_playlist_rows.size()) { refresh_items(false); return; }
 
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
+        std::vector<uint32_t> reordered(count);
+        std::unordered_set<grid_item*> touched;
+        for (size_t i = 0; i < count; i++) {
+            reordered[i] = m_playlist_rows[order[i]];
+            if (order[i] != i && reordered[i] != no_playlist_row) touched.insert(m_snapshot.owner[reordered[i]]);
+        }
+        m_playlist_rows.swap(reordered);
 
-                        return pfc::stricmp_ascii(a->path.c_str(), b->path.c_str()) < 0;
+        apply_row_delta({}, 0, m_snapshot.get_count(), std::move(touched));
+    }
 
-                    });
+    void on_playlist_items_modified(const bit_array& mask) {
+        if (!playlist_delta_ready()) return;
 
-                break;
+        std::vector<uint32_t> rows_to_key;
+        std::vector<size_t> ungrouped;  // playlist indices without a row - fetched again
+        for (size_t i = 0; i < m_playlist_rows.size(); i++) {
+            if (!mask.get(i)) continue;
+            if (m_playlist_rows[i] != no_playlist_row) rows_to_key.push_back(m_playlist_rows[i]);
+            else ungrouped.push_back(i);
+        }
+        const size_t modified_count = rows_to_key.size();
 
-            case grid_config::SORT_BY_RANDOM:
+        metadb_handle_list fresh;
+        if (!ungrouped.empty()) {
+            auto pm = playlist_manager::get();
+            t_size active = pm->get_active_playlist();
+            if (active == pfc::infinite_size || pm->playlist_get_item_count(active) != m_playlist_rows.size()) {
+                refresh_items(false);
+                return;
+            }
+            for (size_t index : ungrouped) fresh.add_item(pm->playlist_get_item_handle(active, index));
+        }
+        const size_t first_new_row = m_snapshot.append(fresh);
+        for (size_t k = 0; k < ungrouped.size(); k++) {
+            m_playlist_rows[ungrouped[k]] = (uint32_t)(first_new_row + k);
+            rows_to_key.push_back((uint32_t)(first_new_row + k));
+        }
 
-                {
+        apply_row_delta(rows_to_key, modified_count, first_new_row, {});
+    }
 
-                    std::random_device rd;
+    void on_playlist_items_replaced(const pfc::list_base_const_t<playlist_callback::t_on_items_replaced_entry>& entries) {
+        if (!playlist_delta_ready()) return;
+        for (t_size k = 0; k < entries.get_count(); k++) {
+            if (entries[k].m_index >= m_playlist_rows.size()) { refresh_items(false); return; }
+        }
 
-                    std::mt19937 gen(rd());
+        std::unordered_set<grid_item*> touched;
+        metadb_handle_list fresh;
+        for (t_size k = 0; k < entries.get_count(); k++) {
+            const uint32_t row = m_playlist_rows[entries[k].m_index];
+            if (row != no_playlist_row) {
+                touched.insert(m_snapshot.owner[row]);
+                m_snapshot.kill_row(row);
+            }
+            fresh.add_item(entries[k].m_new);
+        }
+        const size_t first_new_row = m_snapshot.append(fresh);
+        std::vector<uint32_t> rows_to_key;
+        for (t_size k = 0; k < entries.get_count(); k++) {
+            m_playlist_rows[entries[k].m_index] = (uint32_t)(first_new_row + k);
+            rows_to_key.push_back((uint32_t)(first_new_row + k));
+        }
+
+        apply_row_delta(rows_to_key, 0, first_new_row, std::move(touched));
+    }
+
+    // v10.0.52: Applies a track delta to the grouped model without a rebuild. Callers
+    // have already killed removed rows (their groups in `touched`) and appended new
+    // ones; rows_to_key holds the modified rows first, then the new ones. Only groups
+    // holding affected tracks are refolded and re-sorted (merged back into the sorted
+    // list); everything else - scroll position, selection, loaded thumbnails - stays
+    // as it is, and m_items_generation is left alone since surviving items keep their
+    // identity.
+    void apply_row_delta(const std::vector<uint32_t>& rows_to_key, size_t modified_count,
+                         size_t first_new_row, std::unordered_set<grid_item*> touched) {
+        // Selection and filter results are display indices; remember them by item
+        std::vector<grid_item*> selected_items;
+        for (int index : m_selected_indices) {
+            if (auto* item = get_item_at(index)) selected_items.push_back(item);
+        }
+        std::unordered_set<grid_item*> matched;
+        for (int idx : m_filtered_indices) matched.insert(m_items[idx].get());
+
+        ensure_group_index();
+        std::unordered_map<grid_item*, std::vector<uint32_t>> joined;  // rows that moved into an existing group
+        std::vector<std::unique_ptr<grid_item>> created;
+
+        if (!rows_to_key.empty()) {
+            group_delta_rows(rows_to_key, modified_count, touched, joined, created);
+            m_snapshot.index_rows(first_new_row, m_snapshot.get_count());
+        }
+
+        // Playlist groups list their tracks in playlist order, so their rows are taken
+        // from m_playlist_rows; that pass also forgets rows that lost their group
+        const bool playlist_order = (m_config.view == grid_config::VIEW_PLAYLIST);
+        std::unordered_map<grid_item*, std::vector<uint32_t>> playlist_group_rows;
+        if (playlist_order) {
+            for (uint32_t& row : m_playlist_rows) {
+                if (row == no_playlist_row) continue;
+                grid_item* owner = m_snapshot.owner[row];
+                if (!owner) row = no_playlist_row;
+                else if (touched.count(owner)) playlist_group_rows[owner].push_back(row);
+            }
+        }
 
-                    std::shuffle(m_items.begin(), m_items.end(), gen);
+        if (touched.empty() && created.empty()) return;
 
+        // Refold touched groups from their remaining rows, in their existing track order
+        std::unordered_set<grid_item*> emptied;
+        for (grid_item* item : touched) {
+            std::vector<uint32_t> rows;
+            if (playlist_order) {
+                auto found = playlist_group_rows.find(item);
+                if (found != playlist_group_rows.end()) rows.swap(found->second);
+            } else {
+                rows.reserve(item->tracks.get_count());
+                for (t_size j = 0; j < item->tracks.get_count(); j++) {
+                    int row = m_snapshot.row_of(item->tracks[j]);
+                    if (row >= 0 && m_snapshot.owner[row] == item) rows.push_back((uint32_t)row);
                 }
+                auto more = joined.find(item);
+                if (more != joined.end()) rows.insert(rows.end(), more->second.begin(), more->second.end());
+            }
+            if (rows.empty()) {
+                emptied.insert(item);
+                continue;
+            }
+            metadb_handle_ptr old_representative = item->representative_track;
+            fold_group_rows(*item, m_snapshot, rows);
+            if (item->representative_track != old_representative) {
+                // Cover comes from another track now; a fresh thumbnail also orphans any load in flight
+                thumbnail_cache::remove_thumbnail(item->thumbnail.get());
+                item->thumbnail = std::make_shared<thumbnail_data>();
+            }
+        }
 
-                break;
-
-            case grid_config::SORT_BY_SIZE:
+        // Pull moved and emptied groups out; the rest stays sorted
+        const grid_config::sort_spec sorting = m_items_sorting;
+        const bool ordered = !sorting.is_random();
+        std::unordered_set<grid_item*> moved;
+        std::vector<std::unique_ptr<grid_item>> kept, moving;
+        kept.reserve(m_items.size() + created.size());
+        for (auto& item : m_items) {
+            grid_item* p = item.get();
+            if (emptied.count(p)) {
+                thumbnail_cache::remove_thumbnail(p->thumbnail.get());
+                p->thumbnail->clear();
+                m_group_index.erase(std::string(p->sort_key.c_str(), p->sort_key.length()));
+            } else if (ordered && touched.count(p)) {
+                moved.insert(p);
+                moving.push_back(std::move(item));
+            } else {
+                kept.push_back(std::move(item));
+            }
+        }
+        std::vector<grid_item*> inserted;  // for the stored sort orders
+        if (!m_sort_orders.empty()) {
+            for (grid_item* item : touched) {
+                if (!emptied.count(item)) inserted.push_back(item);
+            }
+        }
+        for (auto& item : created) {
+            moved.insert(item.get());
+            if (!m_sort_orders.empty()) inserted.push_back(item.get());
+            moving.push_back(std::move(item));
+        }
+        if (ordered) {
+            auto less = [sorting](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
+                return grid_item_less(sorting, *a, *b);
+            };
+            std::stable_sort(moving.begin(), moving.end(), less);
+            m_items.clear();
+            m_items.reserve(kept.size() + moving.size());
+            std::merge(std::make_move_iterator(kept.begin()), std::make_move_iterator(kept.end()),
+                       std::make_move_iterator(moving.begin()), std::make_move_iterator(moving.end()),
+                       std::back_inserter(m_items), less);
+        } else {
+            m_items = std::move(kept);
+            for (auto& item : moving) m_items.push_back(std::move(item));
+        }
+        for (auto& entry : m_sort_orders) {
+            update_sort_order(entry.second, touched, inserted);
+        }
 
-                std::sort(m_items.begin(), m_items.end(), 
+        // Re-filter only what moved
+        m_filtered_indices.clear();
+        if (!m_search_text.is_empty()) {
+            for (size_t idx = 0; idx < m_items.size(); idx++) {
+                grid_item* item = m_items[idx].get();
+                bool match = (moved.count(item) || touched.count(item))
+                    ? grid_item_matches_search(*item, m_search_folded) : matched.count(item) != 0;
+                if (match) m_filtered_indices.push_back((int)idx);
+            }
+        }
 
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
+        // Restore selection by item
+        m_selected_indices.clear();
+        if (!selected_items.empty()) {
+            std::unordered_map<grid_item*, int> display_index;
+            for (size_t i = 0; i < get_item_count(); i++) display_index.emplace(get_item_at((int)i), (int)i);
+            for (grid_item* item : selected_items) {
+                auto found = display_index.find(item);
+                if (found != display_index.end()) m_selected_indices.insert(found->second);
+            }
+        }
+        m_hover_index = -1;
 
-                        return a->total_size > b->total_size;
+        int old_now_playing_index = m_now_playing_index;
+        m_now_playing_index = m_now_playing.is_valid() ? find_track_album(m_now_playing) : -1;
+        if (old_now_playing_index != m_now_playing_index) m_layout_cache.invalidate();
+        m_placement_cache_dirty = true;
+        m_jump_index.clear();
+        m_context_menu_cache.invalidate();
+
+        if (m_snapshot.get_dead_count() > 4096 && m_snapshot.get_dead_count() * 4 > m_snapshot.get_count()) {
+            const size_t old_count = m_snapshot.get_count();
+            std::vector<uint32_t> kept_rows = m_snapshot.compact();
+            if (playlist_order) {
+                std::vector<uint32_t> new_row(old_count, no_playlist_row);
+                for (size_t k = 0; k < kept_rows.size(); k++) new_row[kept_rows[k]] = (uint32_t)k;
+                for (uint32_t& row : m_playlist_rows) {
+                    if (row != no_playlist_row) row = new_row[row];
+                }
+            }
+        }
 
-                    });
+        { insync(g_count_sync); g_album_count = m_items.size(); }
+        update_scrollbar();
+        request_invalidate();
+    }
 
-                break;
+    // v10.0.52: Keys rows_to_key and finds their groups: rows whose group exists join it
+    // (joined, touched), the others make new items, which are in m_group_index already
+    // but not in m_items (created). The first modified_count rows had an owner and may
+    // leave it; a row without a key is dropped.
+    void group_delta_rows(const std::vector<uint32_t>& rows_to_key, size_t modified_count,
+                          std::unordered_set<grid_item*>& touched,
+                          std::unordered_map<grid_item*, std::vector<uint32_t>>& joined,
+                          std::vector<std::unique_ptr<grid_item>>& created) {
+        ensure_group_index();
+        with_group_key_extractor(m_config.grouping, [&](const auto& extractor) {
+            std::vector<std::string> keys;
+            key_snapshot_rows(m_snapshot, extractor, rows_to_key, keys);
+
+            std::vector<albumart_grid::track_group> new_groups;
+            std::unordered_map<std::string, size_t> new_group_of_key;
+            for (size_t i = 0; i < rows_to_key.size(); i++) {
+                const uint32_t row = rows_to_key[i];
+                grid_item* old_owner = (i < modified_count) ? m_snapshot.owner[row] : nullptr;
+                if (old_owner) touched.insert(old_owner);
+                if (keys[i].empty()) {
+                    if (old_owner) m_snapshot.kill_row(row);
+                    continue;
+                }
+                if (old_owner && keys[i] == old_owner->sort_key.c_str()) continue;  // same group; the caller refolds it
+                auto existing = m_group_index.find(keys[i]);
+                if (existing != m_group_index.end()) {
+                    m_snapshot.owner[row] = existing->second;
+                    joined[existing->second].push_back(row);
+                    touched.insert(existing->second);
+                } else {
+                    auto found = new_group_of_key.find(keys[i]);
+                    if (found == new_group_of_key.end()) {
+                        new_group_of_key.emplace(keys[i], new_groups.size());
+                        new_groups.push_back(albumart_grid::track_group{keys[i], {row}});
+                    } else {
+                        new_groups[found->second].members.push_back(row);
+                    }
+                }
+            }
 
-            case grid_config::SORT_BY_RATING:
+            auto local_extractor = extractor;
+            for (auto& group : new_groups) {
+                auto item = build_grid_item(m_snapshot, group, local_extractor);
+                if (!item) continue;
+                m_group_index[group.key] = item.get();
+                created.push_back(std::move(item));
+            }
+        });
+    }
 
-                std::sort(m_items.begin(), m_items.end(), 
+    void ensure_group_index() {
+        if (m_group_index_ready) return;
+        m_group_index.clear();
+        m_group_index.reserve(m_items.size());
+        for (auto& item : m_items) {
+            m_group_index.emplace(std::string(item->sort_key.c_str(), item->sort_key.length()), item.get());
+        }
+        m_group_index_ready = true;
+    }
 
-                    [](const std::unique_ptr<grid_item>& a, const std::unique_ptr<grid_item>& b) {
+    // v10.0.52: Puts m_items into m_config.sorting order. The order being left is kept
+    // in m_sort_orders; a stored order for the new spec is applied instead of sorting.
+    // A random order is reshuffled every time and never stored.
+    void sort_items() {
+        const grid_config::sort_spec target = m_config.sorting;
+        if (target == m_items_sorting && !target.is_random()) return;
+
+        if (!m_items_sorting.is_random()) {
+            sort_order& leaving = m_sort_orders[m_items_sorting.id()];
+            leaving.spec = m_items_sorting;
+            leaving.items.resize(m_items.size());
+            leaving.keys.resize(m_items.size());
+            for (size_t i = 0; i < m_items.size(); i++) {
+                grid_item* item = m_items[i].get();
+                get_order_key(*item, m_items_sorting);
+                leaving.items[i] = item;
+                leaving.keys[i].swap(item->cached_order_key);
+                item->cached_order_id = 0;
+            }
+        }
 
-                        return a->rating > b->rating;
+        auto stored = !target.is_random() ? m_sort_orders.find(target.id()) : m_sort_orders.end();
+        if (stored != m_sort_orders.end() && stored->second.items.size() == m_items.size()) {
+            sort_order& order = stored->second;
+            for (auto& item : m_items) item.release();  // same items, re-seated below
+            for (size_t i = 0; i < m_items.size(); i++) {
+                grid_item* item = order.items[i];
+                m_items[i].reset(item);
+                item->cached_order_key.swap(order.keys[i]);
+                item->cached_order_id = target.id();
+            }
+        } else {
+            sort_grid_items(m_items, target);
+        }
+        if (stored != m_sort_orders.end()) m_sort_orders.erase(stored);  // the current order lives in m_items
+        m_items_sorting = target;
+        m_jump_index.clear();
+    }
+
+    // Drops the touched items from a stored order and merges `inserted` (the touched
+    // items that survived, and new ones) back in by their current key
+    static void update_sort_order(sort_order& order, const std::unordered_set<grid_item*>& touched,
+                                  const std::vector<grid_item*>& inserted) {
+        size_t kept = 0;
+        for (size_t i = 0; i < order.items.size(); i++) {
+            if (touched.count(order.items[i])) continue;
+            order.items[kept] = order.items[i];
+            order.keys[kept].swap(order.keys[i]);
+            kept++;
+        }
+        order.items.resize(kept);
+        order.keys.resize(kept);
+        if (inserted.empty()) return;
+
+        std::vector<std::pair<std::string, grid_item*>> fresh(inserted.size());
+        for (size_t i = 0; i < inserted.size(); i++) {
+            build_order_key(order.spec, *inserted[i], fresh[i].first);
+            fresh[i].second = inserted[i];
+        }
+        std::stable_sort(fresh.begin(), fresh.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        sort_order merged;
+        merged.spec = order.spec;
+        merged.items.reserve(kept + fresh.size());
+        merged.keys.reserve(kept + fresh.size());
+        size_t i = 0, j = 0;
+        while (i < kept || j < fresh.size()) {
+            if (j == fresh.size() || (i < kept && !(fresh[j].first < order.keys[i]))) {
+                merged.items.push_back(order.items[i]);
+                merged.keys.push_back(std::move(order.keys[i]));
+                i++;
+            } else {
+                merged.items.push_back(fresh[j].second);
+                merged.keys.push_back(std::move(fresh[j].first));
+                j++;
+            }
+        }
+        order = std::move(merged);
+    }
 
-                    });
+    // Sort mode picked from the menu. Filter results, selection and the now playing
+    // index are positions in m_items, so they are carried across by item.
+    void resort_items() {
+        std::unordered_set<grid_item*> matched;
+        for (int idx : m_filtered_indices) matched.insert(m_items[idx].get());
+        std::vector<grid_item*> selected_items;
+        for (int index : m_selected_indices) {
+            if (auto* item = get_item_at(index)) selected_items.push_back(item);
+        }
 
-                break;
+        sort_items();
 
+        m_filtered_indices.clear();
+        if (!m_search_text.is_empty()) {
+            for (size_t idx = 0; idx < m_items.size(); idx++) {
+                if (matched.count(m_items[idx].get())) m_filtered_indices.push_back((int)idx);
+            }
         }
-
+        m_selected_indices.clear();
+        if (!selected_items.empty()) {
+            std::unordered_map<grid_item*, int> display_index;
+            for (size_t i = 0; i < get_item_count(); i++) display_index.emplace(get_item_at((int)i), (int)i);
+            for (grid_item* item : selected_items) {
+                auto found = display_index.find(item);
+                if (found != display_index.end()) m_selected_indices.insert(found->second);
+            }
+        }
+        m_hover_index = -1;
+        m_now_playing_index = m_now_playing.is_valid() ? find_track_album(m_now_playing) : -1;
+        m_layout_cache.invalidate();
+        m_placement_cache_dirty = true;
     }
 
     
@@ -4924,39 +6705,11 @@ public:
 
         try {
 
-            // Create memory stream
-
-            HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, artwork->get_size());
-
-            if (!hGlobal) return nullptr;
-
-
-
-            void* pImage = GlobalLock(hGlobal);
-
-            if (!pImage) {
-
-                GlobalFree(hGlobal);
-
-                return nullptr;
-
-            }
-
-
-
-            memcpy(pImage, artwork->get_ptr(), artwork->get_size());
-
-            GlobalUnlock(hGlobal);
+            // v10.0.52: Decoded in place (artwork_stream), no GlobalAlloc copy
 
+            stream = artwork_stream::open(artwork);
 
-
-            if (CreateStreamOnHGlobal(hGlobal, TRUE, &stream) != S_OK) {
-
-                GlobalFree(hGlobal);
-
-                return nullptr;
-
-            }
+            if (!stream) return nullptr;
 
 
 
@@ -4964,6 +6717,8 @@ public:
 
             stream->Release();
 
+            stream = nullptr;
+
 
 
             if (!original || original->GetLastStatus() != Gdiplus::Ok) {
@@ -4992,6 +6747,8 @@ public:
 
             if (max_dimension <= target_size * 1.5f) {
 
+                artwork_load_stats::record(artwork->get_size(), artwork_load_stats::bitmap_bytes(original));
+
                 return original;
 
             }
@@ -5026,7 +6783,7 @@ public:
 
 
 
-            {
+            if (!resample_bitmap(original, result)) {
 
                 Gdiplus::Graphics graphics(result);
 
@@ -5054,6 +6811,8 @@ public:
 
 
 
+            artwork_load_stats::record(artwork->get_size(), artwork_load_stats::bitmap_bytes(original) + artwork_load_stats::bitmap_bytes(result));
+
             delete original;
 
             return result;
@@ -5110,73 +6869,39 @@ public:
 
         try {
 
-            // Try creating memory stream with error checking
-
-            HGLOBAL hGlobal = GlobalAlloc(GMEM_MOVEABLE, artwork->get_size());
-
-            if (!hGlobal) {
-
-                console::print("[Album Art Grid v10.0.17] Failed to allocate memory for image");
-
-                return nullptr;
-
-            }
-
-            
-
-            void* pImage = GlobalLock(hGlobal);
-
-            if (!pImage) {
-
-                GlobalFree(hGlobal);
-
-                return nullptr;
-
-            }
-
-            
-
-            memcpy(pImage, artwork->get_ptr(), artwork->get_size());
-
-            GlobalUnlock(hGlobal);
-
-            
+            // v10.0.52: Large JPEGs decode near the target size (decode_jpeg_at_scale());
+            // the rest is decoded in full by GDI+
+            original = decode_jpeg_at_scale(artwork->get_ptr(), artwork->get_size(), size);
+            if (!original) {
+                // v10.0.52: Decoded in place (artwork_stream), no GlobalAlloc copy
 
-            if (CreateStreamOnHGlobal(hGlobal, TRUE, &stream) != S_OK) {
+                stream = artwork_stream::open(artwork);
 
-                GlobalFree(hGlobal);
+                if (!stream) {
 
-                console::print("[Album Art Grid v10.0.17] Failed to create stream for image");
+                    console::print("[Album Art Grid v10.0.17] Failed to create stream for image");
 
-                return nullptr;
+                    return nullptr;
 
-            }
+                }
 
             
 
-            if (!stream) {
+                original = Gdiplus::Bitmap::FromStream(stream);
 
-                console::print("[Album Art Grid v10.0.17] Stream creation failed");
+                stream->Release();
 
-                return nullptr;
-
-            }
+                stream = nullptr;
 
             
 
-            original = Gdiplus::Bitmap::FromStream(stream);
-
-            stream->Release();
-
-            stream = nullptr;
-
-            
+                if (!original || original->GetLastStatus() != Gdiplus::Ok) {
 
-            if (!original || original->GetLastStatus() != Gdiplus::Ok) {
+                    if (original) delete original;
 
-                if (original) delete original;
+                    return nullptr;
 
-                return nullptr;
+                }
 
             }
 
@@ -5194,6 +6919,8 @@ public:
 
             if (orig_width <= size && orig_height <= size) {
 
+                artwork_load_stats::record(artwork->get_size(), artwork_load_stats::bitmap_bytes(original));
+
                 Gdiplus::Bitmap* result = original;
 
                 original = nullptr;
@@ -5232,7 +6959,9 @@ public:
 
             
 
-            {
+            // v10.0.52: resample_bitmap() first; GDI+ only if the bitmaps cannot be locked
+
+            if (!resample_bitmap(original, thumbnail)) {
 
                 Gdiplus::Graphics graphics(thumbnail);
 
@@ -5278,6 +7007,8 @@ public:
 
             
 
+            artwork_load_stats::record(artwork->get_size(), artwork_load_stats::bitmap_bytes(original) + artwork_load_stats::bitmap_bytes(thumbnail));
+
             delete original;
 
             return thumbnail;
@@ -5298,6 +7029,59 @@ public:
 
     }
 
+    // v10.0.52: create_thumbnail() at the size's level (thumbnail_data::level_for()),
+    // resampled to size. level receives the decoded cover, kept with the thumbnail so
+    // a column change within the level never decodes again (rescale_thumbnail()). A
+    // level decoded from the same bytes before is shared instead.
+    Gdiplus::Bitmap* create_leveled_thumbnail(album_art_data_ptr artwork, int size, std::shared_ptr<artwork_level>& level) {
+        level.reset();
+        if (!artwork.is_valid() || artwork->get_size() == 0) return nullptr;
+        const int level_size = thumbnail_data::level_for(size);
+        const uint64_t content = albumart_grid::xxh3_64(artwork->get_ptr(), artwork->get_size());
+        level = thumbnail_cache::find_level(content, artwork->get_size(), level_size);
+        if (!level) {
+            Gdiplus::Bitmap* bitmap = create_thumbnail(artwork, level_size);
+            if (!bitmap) return nullptr;
+            auto fresh = std::make_shared<artwork_level>();
+            fresh->bitmap = bitmap;
+            fresh->size = level_size;
+            fresh->content = content;
+            fresh->encoded_size = artwork->get_size();
+            fresh->whole = (int)std::max(bitmap->GetWidth(), bitmap->GetHeight()) < level_size;
+            level = thumbnail_cache::remember_level(fresh);
+        }
+        Gdiplus::Bitmap* bmp = fit_level(level, size);
+        if (!bmp) level.reset();
+        return bmp;
+    }
+
+    // v10.0.52: Copy of level fitted into size x size - resampled down, never up
+    static Gdiplus::Bitmap* fit_level(const std::shared_ptr<artwork_level>& level, int size) {
+        if (!level || !level->bitmap || size <= 0) return nullptr;
+        insync(level->sync);
+        Gdiplus::Bitmap* source = level->bitmap;
+        const int width = (int)source->GetWidth(), height = (int)source->GetHeight();
+        Gdiplus::Bitmap* bmp = nullptr;
+        if (width <= size && height <= size) {
+            bmp = source->Clone(0, 0, width, height, PixelFormat32bppPARGB);
+        } else {
+            const float scale = std::min((float)size / width, (float)size / height);
+            bmp = new Gdiplus::Bitmap(std::max(1, (int)(width * scale)), std::max(1, (int)(height * scale)), PixelFormat32bppPARGB);
+            if (bmp->GetLastStatus() == Gdiplus::Ok && !resample_bitmap(source, bmp)) {
+                Gdiplus::Graphics graphics(bmp);
+                graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
+                graphics.SetPixelOffsetMode(Gdiplus::PixelOffsetModeHalf);
+                graphics.Clear(Gdiplus::Color(0, 0, 0, 0));
+                graphics.DrawImage(source, 0, 0, (INT)bmp->GetWidth(), (INT)bmp->GetHeight());
+            }
+        }
+        if (bmp && bmp->GetLastStatus() != Gdiplus::Ok) {
+            delete bmp;
+            bmp = nullptr;
+        }
+        return bmp;
+    }
+
     
 
     void toggle_search(bool show) {
@@ -5490,7 +7274,7 @@ public:
 
         // Apply filter and refresh
 
-        apply_filter();
+        apply_filter(true);
 
         m_scroll_pos = 0;  // Reset scroll to top
 
@@ -5564,72 +7348,195 @@ public:
 
     
 
-    void apply_filter() {
-
-        m_filtered_indices.clear();
-
+    // v10.0.52: allow_async lets a long scan run on search_pool() (keystrokes only:
+    // everyone else needs m_filtered_indices to match m_items on return). A query that
+    // extends the last applied one only rechecks that query's hits.
+    void apply_filter(bool allow_async = false) {
+        cancel_search_job();
         m_placement_cache_dirty = true;
-
-        
-
+        m_jump_index.clear();
         if (m_search_text.is_empty()) {
-
             // No filter, show all items
-
+            m_filtered_indices.clear();
+            m_search_hits_query.clear();
+            m_search_hits.clear();
             return;
-
         }
 
-        
-
-        // Convert search text to lowercase for case-insensitive search
-
-        pfc::string8 search_lower = m_search_text;
-
-        pfc::stringToLower(search_lower);
-
-        
+        // Case-insensitive through the search index. (The old copy of the text was
+        // never lowered: pfc::stringToLower() returns its result.)
+        const std::string query = fold_search_text(m_search_text);
+        m_search_folded = query;
+        update_search_index();
+        const albumart_grid::search_index& index = *m_search_index;
+        if (!m_search_hits_query.empty() && m_search_hits_revision == index.revision() &&
+            query.find(m_search_hits_query) != std::string::npos) {
+            index.refine(query, m_search_hits);
+        } else if (allow_async && m_hwnd && index.estimate_work(query) > async_search_entries) {
+            auto job = std::make_shared<search_job>();
+            job->serial = ++m_search_serial;
+            job->query = query;
+            job->index = m_search_index;
+            job->revision = index.revision();
+            m_search_job = job;
+            HWND hwnd = m_hwnd;
+            search_pool().submit([job, hwnd]() {
+                if (!job->index->find(job->query, job->hits, &job->cancelled)) return;
+                job->done.store(true);
+                if (IsWindow(hwnd)) PostMessage(hwnd, WM_APP_SEARCH_READY, (WPARAM)job->serial, 0);
+            });
+            return;
+        } else {
+            index.find(query, m_search_hits);
+        }
+        m_search_hits_query = query;
+        m_search_hits_revision = index.revision();
+        set_filter_hits(index, m_search_hits);
+    }
+
+    LRESULT on_search_ready(WPARAM serial) {
+        std::shared_ptr<search_job> job = m_search_job;
+        if (!job || job->serial != (uint64_t)serial || !job->done.load()) return 0;
+        m_search_job.reset();
+        m_search_hits = std::move(job->hits);
+        m_search_hits_query = job->query;
+        m_search_hits_revision = job->revision;
+        set_filter_hits(*job->index, m_search_hits);
+        m_scroll_pos = 0;
+        update_scrollbar();
+        InvalidateRect(m_hwnd, NULL, FALSE);
+        return 0;
+    }
 
-        // Filter items that match the search text
+    void cancel_search_job() {
+        if (!m_search_job) return;
+        m_search_job->cancelled.store(true);
+        m_search_job.reset();
+    }
 
+    // Replaces m_filtered_indices in one go. Items the index does not know (added or
+    // refolded since it was searched) are matched directly.
+    void set_filter_hits(const albumart_grid::search_index& index, const std::vector<uint32_t>& hits) {
+        std::vector<char> hit(index.size(), 0);
+        for (uint32_t id : hits) hit[id] = 1;
+        std::vector<int> filtered;
         for (size_t idx = 0; idx < m_items.size(); idx++) {
-
-            auto& item = m_items[idx];
-
-            pfc::string8 item_text = item->display_name;
-
-            
-
-            // Also search in artist, album, genre fields
-
-            item_text << " " << item->artist << " " << item->album << " " << item->genre;
-
-            
-
-            // Convert to lowercase for comparison
-
-            pfc::string8 item_lower = item_text;
-
-            pfc::stringToLower(item_lower);
-
-            
-
-            // Check if search text is contained in item text
-
-            if (strstr(item_lower.c_str(), search_lower.c_str()) != nullptr) {
-
-                m_filtered_indices.push_back(idx);
-
-            }
-
+            const grid_item& item = *m_items[idx];
+            const bool match = index.owner(item.search_id) == &item
+                ? hit[item.search_id] != 0 : grid_item_matches_search(item, m_search_folded);
+            if (match) filtered.push_back((int)idx);
         }
+        m_filtered_indices.swap(filtered);
+        m_placement_cache_dirty = true;
+        m_jump_index.clear();
+    }
+
+    // v10.0.52: Adds the items without a current entry (new or refolded since the last
+    // search). Entries are never removed, so the index starts over once stale ones
+    // clearly outnumber the items.
+    void update_search_index() {
+        const bool stale = m_search_index->size() > 2 * m_items.size() + 1024;
+        bool missing = false;
+        for (size_t i = 0; i < m_items.size() && !missing && !stale; i++) {
+            missing = m_search_index->owner(m_items[i]->search_id) != m_items[i].get();
+        }
+        if (!stale && !missing) return;
+        if (stale) {
+            reset_search_index();
+        } else if (m_search_index.use_count() > 1) {  // a search job still reads it
+            m_search_index = std::make_shared<albumart_grid::search_index>(*m_search_index);
+        }
+        albumart_grid::search_index& index = *m_search_index;
+        std::string text;
+        for (const auto& item : m_items) {
+            if (index.owner(item->search_id) == item.get()) continue;
+            build_search_text(*item, text);
+            item->search_id = index.add(item.get(), text);
+        }
+    }
+
+    void reset_search_index() {
+        m_search_index = std::make_shared<albumart_grid::search_index>();
+        m_search_hits_query.clear();
+        m_search_hits.clear();
+    }
+
+    // Artist groupings show the artist image where there is one
+    bool uses_artist_art() const {
+        return m_config.grouping == grid_config::GROUP_BY_ARTIST ||
+               m_config.grouping == grid_config::GROUP_BY_ALBUM_ARTIST ||
+               m_config.grouping == grid_config::GROUP_BY_ARTIST_ALBUM ||
+               m_config.grouping == grid_config::GROUP_BY_PERFORMER ||
+               m_config.grouping == grid_config::GROUP_BY_COMPOSER;
+    }
+
+    static metadb_handle_ptr get_art_track(const grid_item& item) {
+        return item.representative_track.is_valid() ? item.representative_track
+            : (item.tracks.get_count() > 0 ? item.tracks[0] : nullptr);
+    }
+
+    // v10.0.52: What an item's artwork is, independent of the grid_item: art kind plus
+    // the location of the track it is read from. Empty if there is no such track.
+    static std::string get_art_source(const grid_item& item, bool artist_art) {
+        metadb_handle_ptr track = get_art_track(item);
+        if (!track.is_valid()) return std::string();
+        pfc::string8 source;
+        source << (artist_art ? "artist|" : "cover|") << track->get_path() << "|" << track->get_subsong_index();
+        return std::string(source.c_str(), source.length());
+    }
+
+    // v10.0.52: Points the item at a thumbnail that already holds its artwork at this
+    // size, if one is still cached
+    bool attach_known_artwork(grid_item& item, int size, bool artist_art) {
+        std::string source = get_art_source(item, artist_art);
+        if (source.empty()) return false;
+        std::shared_ptr<thumbnail_data> known = thumbnail_cache::find_art(thumbnail_cache::art_key(source, size));
+        if (!known || known == item.thumbnail) return false;
+        item.thumbnail = known;
+        known->touch();
+        thumbnail_cache::add_thumbnail(known, 0);
+        return true;
+    }
 
+    // v10.0.52: Gives the item a new thumbnail holding bmp at size. The one it had is
+    // left as it is: attach_known_artwork() may have shared it with items drawn at its
+    // own size (another panel, say), and by_art still maps its size to it. The cache
+    // drops it once nothing else holds it.
+    std::shared_ptr<thumbnail_data> replace_thumbnail(grid_item& item, Gdiplus::Bitmap* bmp, int size, std::shared_ptr<artwork_level> level) {
+        std::shared_ptr<thumbnail_data> old = item.thumbnail;
+        auto fresh = std::make_shared<thumbnail_data>();
+        fresh->set_bitmap(bmp, size, std::move(level));
+        {
+            insync(g_thumbnail_sync);
+            item.thumbnail = fresh;
+        }
+        if (old && old.use_count() <= 2) thumbnail_cache::remove_thumbnail(old.get());  // held here and by the LRU only
+        thumbnail_cache::add_thumbnail(fresh, 0);
+        return fresh;
+    }
+
+    // v10.0.52: Resamples the item's thumbnail to a new cell size from its level, on
+    // this thread - far cheaper than decoding; load_visible_artwork() spends at most
+    // kRescaleBudgetMs a paint on these. False if the level does not cover the size;
+    // the cover is then decoded again.
+    bool rescale_thumbnail(grid_item& item, int size, bool artist_art) {
+        std::shared_ptr<thumbnail_data> thumbnail = item.thumbnail;
+        if (thumbnail->loading || !thumbnail->level_covers(size)) return false;
+        Gdiplus::Bitmap* bmp = fit_level(thumbnail->level, size);
+        if (!bmp) return false;
+        std::shared_ptr<thumbnail_data> fresh = replace_thumbnail(item, bmp, size, thumbnail->level);
+        std::string source = get_art_source(item, artist_art);
+        if (!source.empty()) thumbnail_cache::remember_art(thumbnail_cache::art_key(source, size), fresh);
+        return true;
     }
 
-    
+    // v10.0.52: A thumbnail drawn at a cell size it was not made for, that its level
+    // cannot serve (or that has none); it is decoded again, showing the old one meanwhile
+    static bool needs_redecode(const thumbnail_data& thumbnail, int size) {
+        return thumbnail.bitmap && std::abs(thumbnail.cached_size - size) > kRescaleSlack && !thumbnail.level_covers(size);
+    }
 
     void load_visible_artwork() {
-
         // CRITICAL FIX: Prevent artwork loading during destruction
 
         if (m_is_destroying.load() || !m_hwnd || !IsWindow(m_hwnd)) return;
@@ -5647,21 +7554,29 @@ public:
         
 
         // Touch visible thumbnails
-
+        // v10.0.52: ...and give rebuilt items artwork that is already decoded
+        bool attached = false;
+        bool rescales_left = false;
+        const bool artist_art = uses_artist_art();
+        const auto rescale_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kRescaleBudgetMs);
         for (int i = m_first_visible; i <= m_last_visible && i < (int)item_count; i++) {
-
             auto* item = get_item_at(i);
-
             if (item && item->thumbnail->bitmap) {
-
                 item->thumbnail->touch();
-
+                // v10.0.52: Cell size changed (columns, panel width) - resample from the level
+                const int size = get_item_size(i);
+                if (std::abs(item->thumbnail->cached_size - size) > kRescaleSlack && item->thumbnail->level_covers(size)) {
+                    if (rescales_left || std::chrono::steady_clock::now() >= rescale_deadline) {
+                        rescales_left = true;
+                    } else {
+                        rescale_thumbnail(*item, size, artist_art);
+                    }
+                }
+            } else if (item && !item->thumbnail->loading && attach_known_artwork(*item, get_item_size(i), artist_art)) {
+                attached = true;
             }
-
         }
-
-        
-
+        if (attached || rescales_left) request_invalidate();
         // Prefetch in scroll direction (detect from scroll position change)
 
         static int last_scroll_pos = 0;
@@ -5710,7 +7625,9 @@ public:
 
                 insync(g_thumbnail_sync);
 
-                if (item->thumbnail->bitmap || item->thumbnail->loading) continue;
+                if (item->thumbnail->loading) continue;
+
+                if (item->thumbnail->bitmap && !needs_redecode(*item->thumbnail, get_item_size(i))) continue;
 
                 if (item->tracks.get_count() == 0) continue;
 
@@ -5736,26 +7653,16 @@ public:
 
             grid_config::enlarged_mode enlarged_mode = m_config.enlarged_now_playing;
 
-            bool use_artist_img = (m_config.grouping == grid_config::GROUP_BY_ARTIST ||
-
-                                   m_config.grouping == grid_config::GROUP_BY_ALBUM_ARTIST ||
-
-                                   m_config.grouping == grid_config::GROUP_BY_ARTIST_ALBUM ||
-
-                                   m_config.grouping == grid_config::GROUP_BY_PERFORMER ||
-
-                                   m_config.grouping == grid_config::GROUP_BY_COMPOSER);
-
-            metadb_handle_ptr track0 = item->representative_track.is_valid() ? item->representative_track
-                : (item->tracks.get_count() > 0 ? item->tracks[0] : nullptr);
-
+            bool use_artist_img = uses_artist_art();
+            metadb_handle_ptr track0 = get_art_track(*item);
             auto art_api = album_art_manager_v2::get();
-
-
-
-            thumb_pool().submit([this, hwnd, task_index, gen, enlarged_mode, use_artist_img, track0, art_api]() {
+            std::weak_ptr<thumbnail_data> target = item->thumbnail;
+            std::string art_source = get_art_source(*item, use_artist_img);
+            thumb_pool().submit([this, hwnd, task_index, gen, enlarged_mode, use_artist_img, track0, art_api, target, art_source]() {
                 Gdiplus::Bitmap* bmp = nullptr;
 
+                std::shared_ptr<artwork_level> level;
+
                 int size_for_item = 0;
 
                 try {
@@ -5784,7 +7691,7 @@ public:
 
                             album_art_data_ptr artist_art = artist_ext->query(album_art_ids::artist, abort);
 
-                            if (artist_art.is_valid()) bmp = create_thumbnail(artist_art, current_size);
+                            if (artist_art.is_valid()) bmp = create_leveled_thumbnail(artist_art, current_size, level);
 
                         }
 
@@ -5810,7 +7717,7 @@ public:
 
                             }
 
-                            if (!bmp) bmp = create_thumbnail(art, current_size);
+                            if (!bmp) bmp = create_leveled_thumbnail(art, current_size, level);
 
                         }
 
@@ -5819,7 +7726,7 @@ public:
                 } catch(...) {}
 
             
-                auto* res = new ThumbnailResult{ task_index, gen, bmp, size_for_item };
+                auto* res = new ThumbnailResult{ task_index, gen, bmp, size_for_item, target, art_source, level };
                 if (hwnd && IsWindow(hwnd)) {
                     PostMessage(hwnd, WM_APP_THUMBNAIL_READY, 0, reinterpret_cast<LPARAM>(res));
                 } else {
@@ -5839,15 +7746,10 @@ public:
             for (int i = prefetch_start; i <= prefetch_end && i < (int)item_count && load_count < 5; i++) {
 
                 auto* item = get_item_at(i);
-
                 if (!item) continue;
-
-                
-
                 if (item->thumbnail->bitmap || item->thumbnail->loading) continue;
-
                 if (item->tracks.get_count() == 0) continue;
-
+                if (attach_known_artwork(*item, get_item_size(i), false)) continue;
                 {
 
                     insync(g_thumbnail_sync);
@@ -5872,14 +7774,15 @@ public:
 
                 grid_config::enlarged_mode enlarged_mode = m_config.enlarged_now_playing;
 
-                metadb_handle_ptr track0 = item->representative_track.is_valid() ? item->representative_track
-                    : (item->tracks.get_count() > 0 ? item->tracks[0] : nullptr);
-
+                metadb_handle_ptr track0 = get_art_track(*item);
                 auto art_api = album_art_manager_v2::get();
-
-                thumb_pool().submit([this, hwnd, task_index, gen, enlarged_mode, track0, art_api]() {
+                std::weak_ptr<thumbnail_data> target = item->thumbnail;
+                std::string art_source = get_art_source(*item, false);  // prefetch loads the front cover only
+                thumb_pool().submit([this, hwnd, task_index, gen, enlarged_mode, track0, art_api, target, art_source]() {
                     Gdiplus::Bitmap* bmp = nullptr;
 
+                    std::shared_ptr<artwork_level> level;
+
                     int size_for_item = 0;
 
                     try {
@@ -5914,7 +7817,7 @@ public:
 
                                 }
 
-                                if (!bmp) bmp = create_thumbnail(art, current_size);
+                                if (!bmp) bmp = create_leveled_thumbnail(art, current_size, level);
 
                             }
 
@@ -5923,7 +7826,7 @@ public:
                     } catch(...) {}
 
                     
-                    auto* res = new ThumbnailResult{ task_index, gen, bmp, size_for_item };
+                    auto* res = new ThumbnailResult{ task_index, gen, bmp, size_for_item, target, art_source, level };
                     if (hwnd && IsWindow(hwnd)) {
                         PostMessage(hwnd, WM_APP_THUMBNAIL_READY, 0, reinterpret_cast<LPARAM>(res));
                     } else {
@@ -5957,16 +7860,19 @@ public:
         }
 
         if (res->generation != m_items_generation.load()) {
-
             if (res->bmp) delete res->bmp;
-
+            // v10.0.52: Thumbnails outlive rebuilds now - don't leave one marked as loading
+            if (auto thumbnail = res->target.lock()) {
+                insync(g_thumbnail_sync);
+                thumbnail->loading = false;
+            }
             return 0;
-
         }
 
-        size_t item_count = get_item_count();
+        // v10.0.52: Deliver to the thumbnail that requested it; gone if its item was removed
+        std::shared_ptr<thumbnail_data> thumbnail = res->target.lock();
 
-        if (res->index < 0 || res->index >= (int)item_count) {
+        if (!thumbnail) {
 
             if (res->bmp) delete res->bmp;
 
@@ -5974,32 +7880,40 @@ public:
 
         }
 
-        auto* item = get_item_at(res->index);
-
-        if (!item) {
-
-            if (res->bmp) delete res->bmp;
-
-            return 0;
+        if (thumbnail->bitmap) {
+            // v10.0.52: A re-decode for a new cell size goes into a thumbnail of the item's
+            // own (replace_thumbnail()); dropped if the item has moved on to another one
+            {
+                insync(g_thumbnail_sync);
+                thumbnail->loading = false;
+            }
+            grid_item* item = get_item_at(res->index);
+            if (!item || item->thumbnail != thumbnail) {
+                if (res->bmp) delete res->bmp;
+                return 0;
+            }
+            thumbnail = replace_thumbnail(*item, res->bmp, res->size, res->level);
+        } else {
 
-        }
+            {
 
-        {
+                insync(g_thumbnail_sync);
 
-            insync(g_thumbnail_sync);
+                thumbnail->set_bitmap(res->bmp, res->size, res->level);
 
-            item->thumbnail->set_bitmap(res->bmp, res->size);
+                thumbnail->loading = false;
 
-            item->thumbnail->loading = false;
+            }
 
+            thumbnail_cache::add_thumbnail(thumbnail, res->index);
+        }
+        if (!res->art_source.empty()) {
+            thumbnail_cache::remember_art(thumbnail_cache::art_key(res->art_source, res->size), thumbnail);
         }
-
-        thumbnail_cache::add_thumbnail(item->thumbnail, res->index);
         InvalidateRect(m_hwnd, NULL, FALSE);
 
-        // Ownership of bmp moved into thumbnail; release pointer from guard
-
-        guard.release();
+        // v10.0.52: guard deletes the result itself (bmp now belongs to the thumbnail);
+        // releasing it instead leaked the result and the level it holds
 
         return 0;
 
@@ -8843,58 +10757,90 @@ public:
 
         HMENU sort_menu = CreatePopupMenu();
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_NAME ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_NAME ? MF_CHECKED : 0), 
 
                    50, TEXT("By Name"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_ARTIST ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_ARTIST ? MF_CHECKED : 0), 
 
                    51, TEXT("By Artist"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_ALBUM ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_ALBUM ? MF_CHECKED : 0), 
 
                    52, TEXT("By Album"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_YEAR ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_YEAR ? MF_CHECKED : 0), 
 
                    53, TEXT("By Year"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_GENRE ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_GENRE ? MF_CHECKED : 0), 
 
                    54, TEXT("By Genre"));
 
         AppendMenu(sort_menu, MF_SEPARATOR, 0, NULL);
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_DATE ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_DATE ? MF_CHECKED : 0), 
 
                    55, TEXT("By Date Modified"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_RELEASE_DATE ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_RELEASE_DATE ? MF_CHECKED : 0), 
 
                    70, TEXT("By Release Date"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_SIZE ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_SIZE ? MF_CHECKED : 0), 
 
                    56, TEXT("By Total Size"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_TRACK_COUNT ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_TRACK_COUNT ? MF_CHECKED : 0), 
 
                    57, TEXT("By Track Count"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_RATING ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_RATING ? MF_CHECKED : 0), 
 
                    58, TEXT("By Rating"));
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_PATH ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_PATH ? MF_CHECKED : 0), 
 
                    59, TEXT("By Path"));
 
         AppendMenu(sort_menu, MF_SEPARATOR, 0, NULL);
 
-        AppendMenu(sort_menu, MF_STRING | (m_config.sorting == grid_config::SORT_BY_RANDOM ? MF_CHECKED : 0), 
+        AppendMenu(sort_menu, MF_STRING | (m_config.sorting.primary() == grid_config::SORT_BY_RANDOM ? MF_CHECKED : 0), 
 
                    69, TEXT("Random/Shuffle"));
 
+        // v10.0.52: Direction of the first field, and the second and third fields with
+        // theirs (grid_config::sort_spec)
+        AppendMenu(sort_menu, MF_SEPARATOR, 0, NULL);
+        const grid_config::sort_spec& sorting = m_config.sorting;
+        const bool reversed = sorting.keys[0].descending != grid_config::sort_spec::descending_by_default(sorting.primary());
+        AppendMenu(sort_menu, MF_STRING | (sorting.is_random() ? MF_GRAYED : 0) | (reversed ? MF_CHECKED : 0),
+                   71, TEXT("Reverse Order"));
+        auto then_by_menu = [&sorting](int position, UINT none_id, UINT first_field_id, UINT ascending_id) {
+            HMENU popup = CreatePopupMenu();
+            const bool present = sorting.count > position;
+            AppendMenu(popup, MF_STRING | (!present ? MF_CHECKED : 0), none_id, TEXT("None"));
+            for (size_t i = 0; i < _countof(g_then_by_fields); i++) {
+                const grid_config::sort_mode field = g_then_by_fields[i].field;
+                bool used = false;
+                for (int k = 0; k < position && k < sorting.count; k++) used = used || sorting.keys[k].field == field;
+                const bool checked = present && sorting.keys[position].field == field;
+                AppendMenu(popup, MF_STRING | (checked ? MF_CHECKED : 0) | (used ? MF_GRAYED : 0),
+                           first_field_id + (UINT)i, g_then_by_fields[i].label);
+            }
+            AppendMenu(popup, MF_SEPARATOR, 0, NULL);
+            const bool descending = present && sorting.keys[position].descending;
+            AppendMenu(popup, MF_STRING | (!present ? MF_GRAYED : 0) | (present && !descending ? MF_CHECKED : 0),
+                       ascending_id, TEXT("Ascending"));
+            AppendMenu(popup, MF_STRING | (!present ? MF_GRAYED : 0) | (descending ? MF_CHECKED : 0),
+                       ascending_id + 1, TEXT("Descending"));
+            return popup;
+        };
+        AppendMenu(sort_menu, MF_POPUP | (sorting.is_random() ? MF_GRAYED : 0),
+                   (UINT_PTR)then_by_menu(1, 72, 73, 96), TEXT("Then By"));
+        AppendMenu(sort_menu, MF_POPUP | (sorting.is_random() || sorting.count < 2 ? MF_GRAYED : 0),
+                   (UINT_PTR)then_by_menu(2, 84, 85, 98), TEXT("And Then By"));
+
         AppendMenu(menu, MF_POPUP, (UINT_PTR)sort_menu, TEXT("Sort"));
 
         
@@ -9261,7 +11207,7 @@ public:
 
                             if (m_selected_indices.size() == 1) {
 
-                                playlist_name = item->display_name;
+                                playlist_name = item->display_name.c_str();
 
                             }
 
@@ -9321,7 +11267,7 @@ public:
 
                             if (m_selected_indices.size() == 1) {
 
-                                playlist_name = item->display_name;
+                                playlist_name = item->display_name.c_str();
 
                             }
 
@@ -9660,29 +11606,54 @@ public:
 
                 break;
 
-            case 50: m_config.sorting = grid_config::SORT_BY_NAME; needs_sort = true; config_changed = true; break;
+            case 50: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_NAME); needs_sort = true; config_changed = true; break;
+
+            case 51: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_ARTIST); needs_sort = true; config_changed = true; break;
+
+            case 52: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_ALBUM); needs_sort = true; config_changed = true; break;
+
+            case 53: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_YEAR); needs_sort = true; config_changed = true; break;
+
+            case 54: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_GENRE); needs_sort = true; config_changed = true; break;
+
+            case 55: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_DATE); needs_sort = true; config_changed = true; break;
+
+            case 70: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_RELEASE_DATE); needs_sort = true; config_changed = true; break;
 
-            case 51: m_config.sorting = grid_config::SORT_BY_ARTIST; needs_sort = true; config_changed = true; break;
+            case 56: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_SIZE); needs_sort = true; config_changed = true; break;
 
-            case 52: m_config.sorting = grid_config::SORT_BY_ALBUM; needs_sort = true; config_changed = true; break;
+            case 57: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_TRACK_COUNT); needs_sort = true; config_changed = true; break;
 
-            case 53: m_config.sorting = grid_config::SORT_BY_YEAR; needs_sort = true; config_changed = true; break;
+            case 58: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_RATING); needs_sort = true; config_changed = true; break;
 
-            case 54: m_config.sorting = grid_config::SORT_BY_GENRE; needs_sort = true; config_changed = true; break;
+            case 59: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_PATH); needs_sort = true; config_changed = true; break;
 
-            case 55: m_config.sorting = grid_config::SORT_BY_DATE; needs_sort = true; config_changed = true; break;
+            case 69: m_config.sorting = grid_config::sort_spec(grid_config::SORT_BY_RANDOM); needs_sort = true; config_changed = true; break;
 
-            case 70: m_config.sorting = grid_config::SORT_BY_RELEASE_DATE; needs_sort = true; config_changed = true; break;
+            case 71: // v10.0.52: Reverse the first sort field
+                if (!m_config.sorting.is_random()) {
+                    m_config.sorting.keys[0].descending = !m_config.sorting.keys[0].descending;
+                    needs_sort = true; config_changed = true;
+                }
+                break;
 
-            case 56: m_config.sorting = grid_config::SORT_BY_SIZE; needs_sort = true; config_changed = true; break;
+            case 72: m_config.sorting.set_then_by(1, grid_config::SORT_BY_RANDOM); needs_sort = true; config_changed = true; break;
+
+            case 73: case 74: case 75: case 76: case 77: case 78: case 79: case 80: case 81: case 82: case 83:
+                m_config.sorting.set_then_by(1, g_then_by_fields[cmd - 73].field);
+                needs_sort = true; config_changed = true;
+                break;
 
-            case 57: m_config.sorting = grid_config::SORT_BY_TRACK_COUNT; needs_sort = true; config_changed = true; break;
+            case 84: m_config.sorting.set_then_by(2, grid_config::SORT_BY_RANDOM); needs_sort = true; config_changed = true; break;
 
-            case 58: m_config.sorting = grid_config::SORT_BY_RATING; needs_sort = true; config_changed = true; break;
+            case 85: case 86: case 87: case 88: case 89: case 90: case 91: case 92: case 93: case 94: case 95:
+                m_config.sorting.set_then_by(2, g_then_by_fields[cmd - 85].field);
+                needs_sort = true; config_changed = true;
+                break;
 
-            case 59: m_config.sorting = grid_config::SORT_BY_PATH; needs_sort = true; config_changed = true; break;
+            case 96: case 97: m_config.sorting.set_descending(1, cmd == 97); needs_sort = true; config_changed = true; break;
 
-            case 69: m_config.sorting = grid_config::SORT_BY_RANDOM; needs_sort = true; config_changed = true; break;
+            case 98: case 99: m_config.sorting.set_descending(2, cmd == 99); needs_sort = true; config_changed = true; break;
 
             case 60: m_config.text_lines = 1; config_changed = true; break;
 
@@ -9842,7 +11813,7 @@ public:
 
         } else if (needs_sort) {
 
-            sort_items();
+            resort_items();
 
             InvalidateRect(m_hwnd, NULL, FALSE);
 
@@ -10156,119 +12127,90 @@ public:
 
 
 
-        if (m_scroll_pos != old_pos) {
-
-            SetScrollPos(m_hwnd, SB_VERT, m_scroll_pos, TRUE);
-
-            InvalidateRect(m_hwnd, NULL, FALSE);
-
-        }
-
-
-
-        m_last_user_scroll = GetTickCount64();
-
-        return 0;
-
-    }
-
-    
-
-    // Function to sort tracks for playlist addition
-
-    void sort_tracks_for_playlist(metadb_handle_list& tracks) {
-
-        if (tracks.get_count() <= 1) return;
-
-        
-
-        switch (m_config.track_sorting) {
-
-            case grid_config::TRACK_SORT_BY_NUMBER:
-
-                {
-                    // Disc-aware (with folder fallback): disc -> track -> path
-                    std::vector<metadb_handle_ptr> vec;
-                    vec.reserve(tracks.get_count());
-                    for (t_size i = 0; i < tracks.get_count(); i++) vec.push_back(tracks[i]);
-
-                    struct key_t { int disc; int track; pfc::string8 path; metadb_handle_ptr h; };
-                    std::vector<key_t> keys;
-                    keys.reserve(vec.size());
-                    for (auto& h : vec) {
-                        key_t k{};
-                        k.disc = get_disc_number_for_handle(h);
-                        k.track = get_track_number_for_handle(h);
-                        try { k.path = h->get_path(); } catch (...) {}
-                        k.h = h;
-                        keys.push_back(std::move(k));
-                    }
+        if (m_scroll_pos != old_pos) {
 
-                    std::stable_sort(keys.begin(), keys.end(), [](const key_t& a, const key_t& b) {
-                        int ad = (a.disc > 0 ? a.disc : 999);
-                        int bd = (b.disc > 0 ? b.disc : 999);
-                        if (ad != bd) return ad < bd;
-                        int at = (a.track > 0 ? a.track : 999);
-                        int bt = (b.track > 0 ? b.track : 999);
-                        if (at != bt) return at < bt;
-                        return pfc::stricmp_ascii(a.path.c_str(), b.path.c_str()) < 0;
-                    });
-
-                    tracks.remove_all();
-                    for (auto& k : keys) tracks.add_item(k.h);
-                }
+            SetScrollPos(m_hwnd, SB_VERT, m_scroll_pos, TRUE);
 
-                break;
+            InvalidateRect(m_hwnd, NULL, FALSE);
 
-            case grid_config::TRACK_SORT_BY_NAME:
+        }
 
-                {
-                    // Disc-aware (with folder fallback): disc -> title -> path
-                    std::vector<metadb_handle_ptr> vec;
-                    vec.reserve(tracks.get_count());
-                    for (t_size i = 0; i < tracks.get_count(); i++) vec.push_back(tracks[i]);
-
-                    struct key_t { int disc; pfc::string8 title; pfc::string8 path; metadb_handle_ptr h; };
-                    std::vector<key_t> keys;
-                    keys.reserve(vec.size());
-                    for (auto& h : vec) {
-                        key_t k{};
-                        k.disc = get_disc_number_for_handle(h);
-                        try {
-                            file_info_impl info;
-                            if (h->get_info(info)) {
-                                const char* t = info.meta_get("TITLE", 0);
-                                if (t) k.title = t;
-                            }
-                        } catch (...) {}
-                        try { k.path = h->get_path(); } catch (...) {}
-                        k.h = h;
-                        keys.push_back(std::move(k));
-                    }
 
-                    std::stable_sort(keys.begin(), keys.end(), [](const key_t& a, const key_t& b) {
-                        int ad = (a.disc > 0 ? a.disc : 999);
-                        int bd = (b.disc > 0 ? b.disc : 999);
-                        if (ad != bd) return ad < bd;
-                        int tcmp = pfc::stricmp_ascii(a.title.c_str(), b.title.c_str());
-                        if (tcmp != 0) return tcmp < 0;
-                        return pfc::stricmp_ascii(a.path.c_str(), b.path.c_str()) < 0;
-                    });
-
-                    tracks.remove_all();
-                    for (auto& k : keys) tracks.add_item(k.h);
-                }
 
-                break;
+        m_last_user_scroll = GetTickCount64();
 
-            case grid_config::TRACK_SORT_NONE:
+        return 0;
 
-                // No sorting - leave tracks in original order
+    }
 
-                break;
+    
 
+    // Function to sort tracks for playlist addition
+    // v10.0.52: Disc-aware (with folder fallback): disc -> track number (or title) ->
+    // path. Keys are read in one pass - from the snapshot for tracks of this view, with
+    // a single get_info_ref() for any other track - and compared as packed integers;
+    // titles and paths are only compared when those tie.
+    void sort_tracks_for_playlist(metadb_handle_list& tracks) {
+        const size_t count = tracks.get_count();
+        if (count <= 1 || m_config.track_sorting == grid_config::TRACK_SORT_NONE) return;
+        const bool by_name = (m_config.track_sorting == grid_config::TRACK_SORT_BY_NAME);
+
+        struct track_key {
+            uint64_t packed;    // disc << 32 | track number (0 by name); 999 stands for none
+            const char* title;  // by name only
+            const char* path;
+            uint32_t index;
+        };
+        std::vector<track_key> keys(count);
+        std::vector<metadb_info_container::ptr> held;  // keeps titles of tracks outside the snapshot valid
+        std::unique_ptr<albumart_grid::directory_cache> directories;  // folder discs of those tracks
+        for (size_t i = 0; i < count; i++) {
+            const metadb_handle_ptr& h = tracks[i];
+            int disc = 0, track = 0;
+            const char* title = nullptr;
+            const char* path = nullptr;
+            int row = m_snapshot.row_of(h);
+            if (row >= 0) {
+                disc = m_snapshot.disc[row];
+                track = m_snapshot.track_number[row];
+                title = m_snapshot.title[row];
+                path = m_snapshot.path[row];
+            } else if (h.is_valid()) {
+                try {
+                    path = h->get_path();
+                    metadb_info_container::ptr info_ref;
+                    const file_info* info = h->get_info_ref(info_ref) ? &info_ref->info() : nullptr;
+                    disc = get_disc_number_from_tags(info);
+                    if (disc <= 0) {
+                        if (!directories) directories = std::make_unique<albumart_grid::directory_cache>();
+                        disc = directories->lookup(path).disc;
+                    }
+                    if (info) {
+                        track = get_track_number_from_info(info);
+                        title = info->meta_get("TITLE", 0);
+                        held.push_back(std::move(info_ref));
+                    }
+                } catch (...) {}
+            }
+            const uint64_t disc_key = disc > 0 ? (uint32_t)disc : 999;
+            const uint64_t track_key_value = by_name ? 0 : (track > 0 ? (uint32_t)track : 999);
+            keys[i] = { disc_key << 32 | track_key_value, by_name ? title : nullptr, path, (uint32_t)i };
         }
 
+        std::stable_sort(keys.begin(), keys.end(), [](const track_key& a, const track_key& b) {
+            if (a.packed != b.packed) return a.packed < b.packed;
+            if (a.title != b.title) {
+                int tcmp = pfc::stricmp_ascii(a.title ? a.title : "", b.title ? b.title : "");
+                if (tcmp != 0) return tcmp < 0;
+            }
+            return pfc::stricmp_ascii(a.path ? a.path : "", b.path ? b.path : "") < 0;
+        });
+
+        metadb_handle_list sorted;
+        sorted.prealloc(count);
+        for (const track_key& key : keys) sorted.add_item(tracks[key.index]);
+        tracks.remove_all();
+        tracks.add_items(sorted);
     }
 
     
@@ -10301,33 +12243,8 @@ public:
 
                 calculate_layout();  // Recalculate item size
 
-
-
-                // Mark thumbnails for regeneration if size changed significantly
-
-                for (auto& item : m_items) {
-
-                    if (item->thumbnail->bitmap && item->thumbnail->cached_size > 0) {
-
-                        int size_diff = abs(item->thumbnail->cached_size - m_item_size);
-
-                        if (size_diff > 20) {
-
-                            // Size changed enough to warrant regeneration
-
-                            // Safe loading flag reset
-
-            if (item && item->thumbnail && !shutdown_protection::is_shutting_down()) {
-
-                item->thumbnail->loading = false;
-
-            }  // Allow regeneration
-
-                        }
-
-                    }
-
-                }
+                // v10.0.52: Thumbnails follow the new size in load_visible_artwork() -
+                // resampled from their level, decoded again only past it
 
 
 
@@ -10719,7 +12636,7 @@ public:
 
         if (m_config.view == grid_config::VIEW_PLAYLIST && m_hwnd) {
 
-            refresh_items();
+            on_playlist_items_added(p_base, p_data);  // v10.0.52: delta, not a rebuild
 
         }
 
@@ -10733,7 +12650,7 @@ public:
 
         if (m_config.view == grid_config::VIEW_PLAYLIST && m_hwnd) {
 
-            refresh_items();
+            on_playlist_items_reordered(p_order, p_count);
 
         }
 
@@ -10761,7 +12678,7 @@ public:
 
         if (m_config.view == grid_config::VIEW_PLAYLIST && m_hwnd) {
 
-            refresh_items();
+            on_playlist_items_removed(p_mask, p_old_count);
 
         }
 
@@ -10795,7 +12712,7 @@ public:
 
         if (m_config.view == grid_config::VIEW_PLAYLIST && m_hwnd) {
 
-            refresh_items();
+            on_playlist_items_modified(p_mask);
 
         }
 
@@ -10819,7 +12736,7 @@ public:
 
         if (m_config.view == grid_config::VIEW_PLAYLIST && m_hwnd) {
 
-            refresh_items();
+            on_playlist_items_replaced(p_data);
 
         }
 
@@ -11061,313 +12978,97 @@ private:
 
         if (!track.is_valid() || m_items.empty()) return -1;
 
-        
-
-        // Get album info from track
-
-        file_info_impl info;
-
-        if (!track->get_info(info)) return -1;
-
-        
+        // v10.0.52: Tracks of the current view map straight to their group via the snapshot
+        int row = m_snapshot.row_of(track);
+        if (row >= 0 && m_snapshot.owner[row]) {
+            for (size_t i = 0; i < m_items.size(); i++) {
+                if (m_items[i].get() == m_snapshot.owner[row]) return (int)i;
+            }
+        }
 
+        // Otherwise match by album/artist
+        metadb_info_container::ptr info_ref;
+        if (!track->get_info_ref(info_ref)) return -1;
+        const file_info& info = info_ref->info();
         const char* album = info.meta_get("ALBUM", 0);
-
         const char* artist = info.meta_get("ARTIST", 0);
-
         if (!artist) artist = info.meta_get("ALBUM ARTIST", 0);
-
-        
-
-        // Find matching album in grid
+        if (!album) return -1;
 
         for (size_t i = 0; i < m_items.size(); i++) {
-
             auto& item = m_items[i];
-
-            
-
-            // Check if any track in this item matches
-
-            for (size_t j = 0; j < item->tracks.get_count(); j++) {
-
-                if (item->tracks[j] == track) {
-
-                    return i;
-
-                }
-
-            }
-
-            
-
-            // Alternative: match by album/artist
-
-            if (album && item->album == album) {
-
-                if (!artist || item->artist == artist) {
-
-                    return i;
-
-                }
-
+            if (item->album == album && (!artist || item->artist == artist)) {
+                return (int)i;
             }
-
         }
 
-        
-
         return -1;
-
     }
 
     
 
+    // v10.0.52: Type-ahead. Keys typed within type_ahead_timeout_ms of each other
+    // make up a prefix, found from the current item on; one key, pressed once or
+    // repeatedly, steps through the items starting with it. Matches the labels as displayed
+    // (label_style), over the display list, so filtered views jump to the right item.
     void jump_to_letter(char letter) {
-
-        if (m_items.empty() || !m_hwnd) return;
-
-        
-
-        // Convert to uppercase for comparison
-
-        char target = toupper(letter);
-
-        
-
-        // Determine start position for search
-
-        int start_index = 0;
-
-        if (target == m_last_jump_letter && m_last_jump_index >= 0) {
-
-            // Same letter pressed again - cycle to next match
-
-            start_index = m_last_jump_index + 1;
-
-        }
-
-        
-
-        // Find next item that starts with this letter
-
-        // Jump based on what's actually displayed (label format)
-
-        int found_index = -1;
-
-        
-
-        // Two-pass search: from start_index to end, then from 0 to start_index (wrap around)
-
-        for (int pass = 0; pass < 2 && found_index < 0; pass++) {
-
-            int begin = (pass == 0) ? start_index : 0;
-
-            int end = (pass == 0) ? (int)m_items.size() : start_index;
-
-            
-
-            for (int i = begin; i < end; i++) {
-
-                // Skip if filtering and item doesn't match
-
-                if (!m_search_text.is_empty()) {
-
-                    bool matches = false;
-
-                    const auto& item = m_items[i];
-
-                    if (item) {
-
-                        pfc::string8 search_lower = m_search_text;
-
-                        pfc::string8 album_lower = item->album.c_str();
-
-                        pfc::string8 artist_lower = item->artist.c_str();
-
-                        
-
-                        pfc::stringToLower(search_lower);
-
-                        pfc::stringToLower(album_lower);
-
-                        pfc::stringToLower(artist_lower);
-
-                        
-
-                        if (strstr(album_lower.c_str(), search_lower.c_str()) ||
-
-                            strstr(artist_lower.c_str(), search_lower.c_str())) {
-
-                            matches = true;
-
-                        }
-
-                    }
-
-                    if (!matches) continue;
-
-                }
-
-                
-
-                // Get first character based on display format (what user actually sees)
-
-                char first_char = 0;
-
-                const auto& item = m_items[i];
-
-                if (!item) continue;
-
-                
-
-                // Smart jump: use label format to determine what to jump by
-
-                switch (m_config.label_style) {
-
-                    case grid_config::LABEL_ARTIST_ALBUM:
-
-                    case grid_config::LABEL_ARTIST_ONLY:
-
-                        // When showing artist first, jump by artist
-
-                        if (!item->artist.empty()) {
-
-                            first_char = toupper(item->artist[0]);
-
-                        }
-
-                        break;
-
-                        
-
-                    case grid_config::LABEL_ALBUM_ONLY:
-
-                        // When showing album only, jump by album
-
-                        if (!item->album.empty()) {
-
-                            first_char = toupper(item->album[0]);
-
-                        }
-
-                        break;
-
-                        
-
-                    case grid_config::LABEL_FOLDER_NAME:
-
-                        // When showing folder name, jump by folder
-
-                        if (!item->folder_name.is_empty()) {
-
-                            first_char = toupper(item->folder_name[0]);
-
-                        } else if (!item->path.empty()) {
-
-                            const char* last_slash = strrchr(item->path.c_str(), '\\');
-
-                            if (last_slash && *(last_slash + 1)) {
-
-                                first_char = toupper(*(last_slash + 1));
-
-                            }
-
-                        }
-
-                        break;
-
-                        
-
-                    default:
-
-                        // Fallback to album
-
-                        if (!item->album.empty()) {
-
-                            first_char = toupper(item->album[0]);
-
-                        }
-
-                        break;
-
-                }
-
-                
-
-                // Check if this item starts with our target letter
-
-                if (first_char == target) {
-
-                    found_index = i;
-
-                    break;
-
-                }
-
-            }
-
+        const size_t count = get_item_count();
+        if (count == 0 || !m_hwnd) return;
+        update_jump_index();
+
+        const char key = (char)tolower((unsigned char)letter);
+        const ULONGLONG now = GetTickCount64();
+        if (now - m_type_ahead_tick > type_ahead_timeout_ms) m_type_ahead.clear();
+        m_type_ahead_tick = now;
+        m_type_ahead.push_back(key);
+
+        const size_t current = m_last_selected >= 0 && (size_t)m_last_selected < count ? (size_t)m_last_selected : 0;
+        size_t found;
+        if (m_type_ahead.find_first_not_of(key) == std::string::npos) {
+            // From the top, or past the current item if it starts with the key already
+            const std::string_view label = m_jump_index.label((uint32_t)current);
+            const bool on_key = !label.empty() && label[0] == key;
+            found = m_jump_index.next_with_first((unsigned char)key, on_key ? current + 1 : 0);
+        } else {
+            found = m_jump_index.find_prefix(m_type_ahead, current);
         }
+        if (found == albumart_grid::jump_index::npos) return;
 
-        
-
-        // If we found a matching item, scroll to it
-
-        if (found_index >= 0) {
-
-            // Calculate target scroll position
-
-            int row = found_index / std::max(1, m_config.columns);
-
-            int text_height = calculate_text_height();
-
-            int item_total_height = m_item_size + text_height;
-
-            int target_scroll = row * (item_total_height + PADDING);
-
-            
-
-            // Update scroll position
-
-            m_scroll_pos = target_scroll;
-
+        // Scroll the item's row to the top
+        calculate_layout();
+        rebuild_placement_map(std::max(1, m_config.columns));
+        auto placement = m_item_placements.find((int)found);
+        if (placement != m_item_placements.end()) {
+            m_scroll_pos = placement->second.row * (m_item_size + calculate_text_height() + PADDING);
             update_scrollbar();
-
-            
-
-            // Select the item for visual feedback
-
-            m_selected_indices.clear();
-
-            m_selected_indices.insert(found_index);
-
-            m_last_selected = found_index;
-
-            
-
-            // Remember for cycling
-
-            m_last_jump_letter = target;
-
-            m_last_jump_index = found_index;
-
-            
-
-            InvalidateRect(m_hwnd, NULL, FALSE);
-
-        } else {
-
-            // No match found, reset cycling
-
-            m_last_jump_letter = 0;
-
-            m_last_jump_index = -1;
-
         }
 
+        // Select the item for visual feedback
+        m_selected_indices.clear();
+        m_selected_indices.insert((int)found);
+        m_last_selected = (int)found;
+        InvalidateRect(m_hwnd, NULL, FALSE);
     }
 
-    
+    // v10.0.52: Rebuilt on the next key once cleared (display list or order changed),
+    // or when the label style is no longer the one it was built for
+    void update_jump_index() {
+        const size_t count = get_item_count();
+        if (m_jump_index.size() == count && m_jump_label_style == (int)m_config.label_style) return;
+        m_jump_index.clear();
+        m_jump_label_style = (int)m_config.label_style;
+        std::string folded;
+        for (size_t i = 0; i < count; i++) {
+            folded.clear();
+            const grid_item* item = get_item_at(i);
+            if (item) {
+                pfc::string8 text = item->get_display_text(m_config.label_style);
+                append_folded_text(folded, text.c_str(), text.length());
+            }
+            m_jump_index.add(folded);
+        }
+        m_jump_index.finish();
+    }
 
     void jump_to_now_playing(bool animate = true) {
 
@@ -11877,6 +13578,9 @@ public:
 
         console::print("initquit::quit entry");
 
+        artwork_load_stats::print();
+        thumbnail_cache::print_stats();
+
         
 
         // Set LOCAL shutdown flag (not global!)
@@ -11907,6 +13611,9 @@ public:
 
         
 
+        // v10.0.52: Loaders still running keep their own reference to the factory
+        release_wic_factory();
+
         // Shutdown GDI+ using helper function with SEH
 
         shutdown_gdiplus_safe(m_gdiplusToken);
@@ -0,0 +1,241 @@
+#pragma once
+
+// Sharded, parallel grouping of tracks by string key.
+//
+// The input is cut into fixed-size shards. Workers take shards off a shared
+// counter and build hash-keyed partial groups for them; the partial groups are
+// then merged shard by shard. Because shards are contiguous and merged in input
+// order, every group lists its members in input order and its first member is the
+// same track a serial pass would have seen first.
+//
+// Groups come out ordered like std::map<pfc::string8, ...> (shorter keys first,
+// then bytewise), which is what refresh_items() iterated before, so downstream
+// sorting sees an identical starting sequence.
+//
+// Nothing here depends on the foobar2000 SDK - the caller supplies the key
+// callback, so the engine can be driven headless with synthetic tracks
+// (tests/grouping_bench.cpp).
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace albumart_grid {
+
+struct grouping_options {
+    size_t shard_size = 2048;   // tracks per shard
+    unsigned max_threads = 0;   // 0 = std::thread::hardware_concurrency(), else at most this many
+    const std::atomic<bool>* cancel = nullptr;  // polled per shard; set = give up, return nothing
+};
+
+struct track_group {
+    std::string key;
+    std::vector<uint32_t> members;  // input indices, ascending
+};
+
+// Same ordering as pfc::string8::operator< (length first, then memcmp)
+inline bool group_key_less(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return a.size() < b.size();
+    return memcmp(a.data(), b.data(), a.size()) < 0;
+}
+
+// Threads for the chunks, calling thread included: max_threads if given (tests
+// use more than the hardware has), otherwise the hardware threads; never more
+// than there are chunks
+inline unsigned grouping_thread_count(size_t chunks, unsigned max_threads) {
+    unsigned threads = max_threads;
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    return (unsigned)std::max<size_t>(1, std::min<size_t>(threads, chunks));
+}
+
+// Helper threads parallel_for_chunks() hands work to. They start on first use
+// and stay, so a call costs a wake-up instead of creating and joining threads.
+class chunk_workers {
+public:
+    static chunk_workers& shared() {
+        static chunk_workers workers;
+        return workers;
+    }
+
+    chunk_workers() = default;
+    chunk_workers(const chunk_workers&) = delete;
+    chunk_workers& operator=(const chunk_workers&) = delete;
+
+    ~chunk_workers() {
+        {
+            std::lock_guard<std::mutex> lk(m_sync);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& t : m_threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    // Queues copies copies of task, with at least that many threads to run them
+    void run(size_t copies, const std::function<void()>& task) {
+        {
+            std::lock_guard<std::mutex> lk(m_sync);
+            while (m_threads.size() < copies) m_threads.emplace_back([this] { work(); });
+            for (size_t i = 0; i < copies; i++) m_tasks.push_back(task);
+        }
+        m_wake.notify_all();
+    }
+
+private:
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lk(m_sync);
+                m_wake.wait(lk, [this] { return m_stop || !m_tasks.empty(); });
+                if (m_stop && m_tasks.empty()) return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_sync;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+};
+
+// Calls fn(begin, end) for consecutive chunks of [0, count) on up to
+// max_threads threads: the calling thread and helpers from chunk_workers. The
+// first exception thrown by fn is rethrown once no helper runs fn any more.
+// With one thread (or one chunk) fn gets all of [0, count) in one call.
+//
+// Helpers only join while the call is open. One that gets to run after the
+// caller finished every chunk finds the call closed and leaves without touching
+// it, so the caller never waits for helpers still queued behind other work.
+template <typename Fn>
+void parallel_for_chunks(size_t count, size_t chunk, unsigned max_threads, Fn&& fn) {
+    if (count == 0) return;
+    chunk = std::max<size_t>(1, chunk);
+    const size_t chunks = (count + chunk - 1) / chunk;
+    const unsigned threads = grouping_thread_count(chunks, max_threads);
+    if (threads <= 1) {
+        fn((size_t)0, count);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_sync;
+    auto run_chunks = [&]() {
+        for (;;) {
+            size_t c = next.fetch_add(1);
+            if (c >= chunks) return;
+            size_t begin = c * chunk;
+            try {
+                fn(begin, std::min(count, begin + chunk));
+            } catch (...) {
+                std::lock_guard<std::mutex> lk(error_sync);
+                if (!error) error = std::current_exception();
+            }
+        }
+    };
+
+    struct call_state {
+        std::mutex sync;
+        std::condition_variable idle;
+        bool closed = false;
+        unsigned active = 0;
+        std::function<void()> run;  // refers to the caller's frame - only called while open
+    };
+    auto state = std::make_shared<call_state>();
+    state->run = run_chunks;
+    chunk_workers::shared().run(threads - 1, [state]() {
+        {
+            std::lock_guard<std::mutex> lk(state->sync);
+            if (state->closed) return;
+            state->active++;
+        }
+        state->run();
+        std::lock_guard<std::mutex> lk(state->sync);
+        if (--state->active == 0) state->idle.notify_all();
+    });
+    run_chunks();
+    {
+        std::unique_lock<std::mutex> lk(state->sync);
+        state->closed = true;
+        state->idle.wait(lk, [&state] { return state->active == 0; });
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+// key_fn(size_t index, std::string& key) -> bool is called once per track.
+// Every shard works on its own copy of key_fn, so it may keep scratch buffers,
+// but anything it references is read from several threads at once. Return
+// false to leave the track out.
+template <typename KeyFn>
+std::vector<track_group> group_tracks_sharded(size_t count, KeyFn&& key_fn,
+                                              const grouping_options& opt = grouping_options()) {
+    std::vector<track_group> out;
+    if (count == 0) return out;
+
+    const size_t shard_size = std::max<size_t>(1, opt.shard_size);
+    const size_t shard_count = (count + shard_size - 1) / shard_size;
+
+    // Phase 1: per-shard partial groups, in first-seen order within the shard
+    std::vector<std::vector<track_group>> shards(shard_count);
+    parallel_for_chunks(count, shard_size, opt.max_threads, [&](size_t begin, size_t end) {
+        if (opt.cancel && opt.cancel->load(std::memory_order_relaxed)) return;
+        std::vector<track_group>& local = shards[begin / shard_size];
+        std::unordered_map<std::string, size_t> index;
+        auto local_key_fn = key_fn;
+        std::string key;
+        for (size_t i = begin; i < end; ++i) {
+            key.clear();
+            if (!local_key_fn(i, key)) continue;
+            auto found = index.find(key);
+            if (found == index.end()) {
+                index.emplace(key, local.size());
+                local.push_back(track_group{key, {(uint32_t)i}});
+            } else {
+                local[found->second].members.push_back((uint32_t)i);
+            }
+        }
+    });
+
+    if (opt.cancel && opt.cancel->load()) return out;
+
+    // Phase 2: deterministic merge - shards in input order keep members ascending
+    std::unordered_map<std::string, size_t> merged;
+    for (auto& shard : shards) {
+        for (auto& part : shard) {
+            auto found = merged.find(part.key);
+            if (found == merged.end()) {
+                merged.emplace(part.key, out.size());
+                out.push_back(std::move(part));
+            } else {
+                auto& dst = out[found->second].members;
+                dst.insert(dst.end(), part.members.begin(), part.members.end());
+            }
+        }
+        std::vector<track_group>().swap(shard);
+    }
+
+    std::sort(out.begin(), out.end(), [](const track_group& a, const track_group& b) {
+        return group_key_less(a.key, b.key);
+    });
+    return out;
+}
+
+} // namespace albumart_grid
@@ -0,0 +1,80 @@
+#pragma once
+
+// Cheap looks at encoded artwork before it is decoded.
+//
+// sniff_image_format() tells the container from its signature bytes, and
+// read_jpeg_size() walks a JPEG's marker segments up to the frame header for
+// its dimensions, so neither touches the entropy-coded data. With those the
+// thumbnail path picks jpeg_scale_denominator(): a JPEG decoder can scale by
+// 1/2, 1/4 or 1/8 in the DCT domain, skipping the pixels a thumbnail would
+// throw away; the picked scale still covers the target, so the final resample
+// only ever shrinks.
+//
+// No foobar2000 SDK dependency.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace albumart_grid {
+
+enum class image_format { unknown, jpeg, png, gif, bmp, webp, tiff };
+
+inline image_format sniff_image_format(const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    if (!p) return image_format::unknown;
+    if (size >= 3 && p[0] == 0xFF && p[1] == 0xD8 && p[2] == 0xFF) return image_format::jpeg;
+    if (size >= 8 && memcmp(p, "\x89PNG\r\n\x1a\n", 8) == 0) return image_format::png;
+    if (size >= 6 && (memcmp(p, "GIF87a", 6) == 0 || memcmp(p, "GIF89a", 6) == 0)) return image_format::gif;
+    if (size >= 2 && p[0] == 'B' && p[1] == 'M') return image_format::bmp;
+    if (size >= 12 && memcmp(p, "RIFF", 4) == 0 && memcmp(p + 8, "WEBP", 4) == 0) return image_format::webp;
+    if (size >= 4 && (memcmp(p, "II*\0", 4) == 0 || memcmp(p, "MM\0*", 4) == 0)) return image_format::tiff;
+    return image_format::unknown;
+}
+
+// Dimensions from the first frame header (SOF0-SOF15 but DHT, JPG and DAC);
+// false if the data ends or goes astray before one
+inline bool read_jpeg_size(const void* data, size_t size, uint32_t& width, uint32_t& height) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    if (!p || size < 4 || p[0] != 0xFF || p[1] != 0xD8) return false;
+    size_t at = 2;
+    while (at + 4 <= size) {
+        if (p[at] != 0xFF) return false;
+        const unsigned char marker = p[at + 1];
+        if (marker == 0xFF) {  // fill byte
+            at++;
+            continue;
+        }
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {  // no length
+            at += 2;
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA) return false;  // image data before any frame header
+        const size_t length = (size_t)p[at + 2] << 8 | p[at + 3];
+        if (length < 2 || at + 2 + length > size) return false;
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (length < 7) return false;
+            height = (uint32_t)p[at + 5] << 8 | p[at + 6];
+            width = (uint32_t)p[at + 7] << 8 | p[at + 8];
+            return width > 0 && height > 0;
+        }
+        at += 2 + length;
+    }
+    return false;
+}
+
+// A side of the image decoded at 1/denominator, as JPEG decoders round it
+inline uint32_t jpeg_scaled_dimension(uint32_t dimension, unsigned denominator) {
+    return (dimension + denominator - 1) / denominator;
+}
+
+// Largest of 8, 4, 2 and 1 that keeps the longer side at target or more
+inline unsigned jpeg_scale_denominator(uint32_t width, uint32_t height, uint32_t target) {
+    const uint32_t longer = width > height ? width : height;
+    for (unsigned denominator = 8; denominator > 1; denominator /= 2) {
+        if (jpeg_scaled_dimension(longer, denominator) >= target) return denominator;
+    }
+    return 1;
+}
+
+} // namespace albumart_grid
@@ -0,0 +1,118 @@
+#pragma once
+
+// Type-ahead lookup over the labels of the grid's display list.
+//
+// Every display position adds its label, folded by the caller the same way as
+// the keys typed. finish() sorts the positions by label, so a typed prefix is
+// found by binary search, and groups them by the label's first byte in display
+// order, so pressing the same key again steps to the next item starting with
+// it without looking at the others.
+//
+// Positions are display indices: the caller clears the index whenever the
+// display list, its order or the label style changes, and adds the labels again
+// before the next lookup.
+//
+// No foobar2000 SDK dependency.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace albumart_grid {
+
+class jump_index {
+public:
+    static const size_t npos = SIZE_MAX;
+
+    void clear() {
+        m_text.clear();
+        m_offsets.clear();
+        m_sorted.clear();
+        m_by_first.clear();
+        memset(m_first_start, 0, sizeof(m_first_start));
+    }
+
+    size_t size() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    // The label of the next display position
+    void add(std::string_view folded) {
+        if (m_offsets.empty()) m_offsets.push_back(0);
+        m_text.append(folded.data(), folded.size());
+        m_offsets.push_back((uint32_t)m_text.size());
+    }
+
+    // Call once every label is added
+    void finish() {
+        const uint32_t count = (uint32_t)size();
+        m_sorted.resize(count);
+        for (uint32_t i = 0; i < count; i++) m_sorted[i] = i;
+        std::stable_sort(m_sorted.begin(), m_sorted.end(), [this](uint32_t a, uint32_t b) {
+            return label(a) < label(b);
+        });
+
+        // Counting sort by first byte keeps each bucket in display order
+        size_t count_of[257] = {};
+        for (uint32_t i = 0; i < count; i++) count_of[bucket_of(i)]++;
+        size_t sum = 0;
+        for (unsigned b = 0; b < 257; b++) {
+            m_first_start[b] = sum;
+            sum += count_of[b];
+        }
+        m_first_start[257] = sum;
+        size_t next[257];
+        memcpy(next, m_first_start, sizeof(next));
+        m_by_first.resize(count);
+        for (uint32_t i = 0; i < count; i++) m_by_first[next[bucket_of(i)]++] = i;
+    }
+
+    std::string_view label(uint32_t position) const {
+        return std::string_view(m_text.data() + m_offsets[position], m_offsets[position + 1] - m_offsets[position]);
+    }
+
+    // First position at or after from whose label starts with byte c, wrapping
+    // around to the top; npos if there is none
+    size_t next_with_first(unsigned char c, size_t from) const {
+        const uint32_t* first = m_by_first.data() + m_first_start[(unsigned)c + 1];
+        const uint32_t* last = m_by_first.data() + m_first_start[(unsigned)c + 2];
+        if (first == last) return npos;
+        const uint32_t* at = std::lower_bound(first, last, from);
+        return at != last ? *at : *first;
+    }
+
+    // First position at or after from whose label starts with prefix, wrapping
+    // around to the top; npos if there is none. The labels with the prefix are
+    // one run of the sorted order, found by binary search; only that run is
+    // looked at.
+    size_t find_prefix(std::string_view prefix, size_t from) const {
+        if (prefix.empty()) return npos;
+        if (prefix.size() == 1) return next_with_first((unsigned char)prefix[0], from);
+        auto begin = std::lower_bound(m_sorted.begin(), m_sorted.end(), prefix, [this](uint32_t position, std::string_view p) {
+            return label(position) < p;
+        });
+        size_t ahead = npos, wrapped = npos;
+        for (auto it = begin; it != m_sorted.end(); ++it) {
+            if (label(*it).compare(0, prefix.size(), prefix) != 0) break;
+            if (*it >= from) ahead = std::min(ahead, (size_t)*it);
+            else wrapped = std::min(wrapped, (size_t)*it);
+        }
+        return ahead != npos ? ahead : wrapped;
+    }
+
+private:
+    // 0 for an empty label, first byte + 1 otherwise
+    unsigned bucket_of(uint32_t position) const {
+        return m_offsets[position + 1] > m_offsets[position] ? (unsigned)(unsigned char)m_text[m_offsets[position]] + 1 : 0;
+    }
+
+    std::string m_text;               // every label back to back
+    std::vector<uint32_t> m_offsets;  // label i is [m_offsets[i], m_offsets[i + 1])
+    std::vector<uint32_t> m_sorted;   // positions by label, then position
+    std::vector<uint32_t> m_by_first; // positions by first byte, then position
+    size_t m_first_start[258] = {};   // bucket b is m_by_first[m_first_start[b], m_first_start[b + 1])
+};
+
+} // namespace albumart_grid
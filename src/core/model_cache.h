@@ -0,0 +1,200 @@
+#pragma once
+
+// On-disk snapshot of a grouped and sorted grid model.
+//
+// Layout (all integers little-endian, records 8-byte aligned):
+//
+//   model_cache_header
+//   model_cache_item  [item_count]    in display order
+//   model_cache_track [track_count]   grouped by item, item order
+//   string blob                       NUL-terminated UTF-8, offset 0 is ""
+//
+// Text fields are offsets into the blob; identical strings are stored once.
+// Tracks keep their location split into directory and file name so the
+// directory text is shared by every track of an album.
+//
+// model_cache_view reads a file image in place (e.g. a mapped view) after
+// checking that every offset stays inside it, so a truncated or foreign
+// file is rejected instead of crashing the reader. Bump model_cache_version
+// whenever a record changes.
+//
+// No foobar2000 SDK dependency.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace albumart_grid {
+
+static const uint32_t model_cache_version = 2;
+
+struct model_cache_header {
+    char magic[4];             // "AAGM"
+    uint32_t version;
+    uint32_t header_size;
+    int32_t view;              // grid_config::view_mode
+    int32_t grouping;          // grid_config::group_mode
+    int32_t sorting;           // grid_config::sort_spec::id()
+    uint32_t item_count;
+    uint32_t track_count;
+    uint64_t items_offset;
+    uint64_t tracks_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    uint64_t file_size;
+};
+
+struct model_cache_item {
+    uint32_t display_name, folder_name, sort_key, path;
+    uint32_t artist, album, genre, year;
+    uint64_t newest_date;
+    uint64_t total_size;
+    int32_t rating;
+    uint32_t release_date_key;
+    uint32_t disc_mask;
+    uint32_t disc_count;
+    uint32_t first_track;
+    uint32_t track_count;
+    uint32_t representative;   // index into the item's tracks
+    uint32_t reserved;
+};
+
+struct model_cache_track {
+    uint32_t directory;        // up to and including the last separator
+    uint32_t file_name;
+    uint32_t subsong;
+};
+
+class model_cache_writer {
+public:
+    model_cache_writer() { m_strings.push_back('\0'); }
+
+    uint32_t add_string(const char* s) { return s ? add_string(s, strlen(s)) : 0; }
+
+    uint32_t add_string(const char* s, size_t n) {
+        if (!s || n == 0) return 0;
+        auto found = m_string_index.find(std::string(s, n));
+        if (found != m_string_index.end()) return found->second;
+        const uint32_t offset = (uint32_t)m_strings.size();
+        m_strings.insert(m_strings.end(), s, s + n);
+        m_strings.push_back('\0');
+        m_string_index.emplace(std::string(s, n), offset);
+        return offset;
+    }
+
+    // Starts the next item; its tracks follow through add_track()
+    model_cache_item& add_item() {
+        model_cache_item item;
+        memset(&item, 0, sizeof(item));
+        item.first_track = (uint32_t)m_tracks.size();
+        m_items.push_back(item);
+        return m_items.back();
+    }
+
+    void add_track(const char* path, uint32_t subsong) {
+        const char* slash = strrchr(path, '\\');
+        const char* other = strrchr(path, '/');
+        if (!slash || (other && other > slash)) slash = other;
+        const size_t dir_len = slash ? (size_t)(slash - path) + 1 : 0;
+        model_cache_track track;
+        track.directory = add_string(path, dir_len);
+        track.file_name = add_string(path + dir_len);
+        track.subsong = subsong;
+        m_tracks.push_back(track);
+        m_items.back().track_count++;
+    }
+
+    std::vector<char> finish(int32_t view, int32_t grouping, int32_t sorting) const {
+        model_cache_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "AAGM", 4);
+        header.version = model_cache_version;
+        header.header_size = sizeof(header);
+        header.view = view;
+        header.grouping = grouping;
+        header.sorting = sorting;
+        header.item_count = (uint32_t)m_items.size();
+        header.track_count = (uint32_t)m_tracks.size();
+        header.items_offset = align(sizeof(header));
+        header.tracks_offset = align(header.items_offset + m_items.size() * sizeof(model_cache_item));
+        header.strings_offset = align(header.tracks_offset + m_tracks.size() * sizeof(model_cache_track));
+        header.strings_size = m_strings.size();
+        header.file_size = header.strings_offset + header.strings_size;
+
+        std::vector<char> out((size_t)header.file_size, 0);
+        memcpy(out.data(), &header, sizeof(header));
+        if (!m_items.empty()) memcpy(out.data() + header.items_offset, m_items.data(), m_items.size() * sizeof(model_cache_item));
+        if (!m_tracks.empty()) memcpy(out.data() + header.tracks_offset, m_tracks.data(), m_tracks.size() * sizeof(model_cache_track));
+        memcpy(out.data() + header.strings_offset, m_strings.data(), m_strings.size());
+        return out;
+    }
+
+private:
+    static uint64_t align(uint64_t offset) { return (offset + 7) & ~(uint64_t)7; }
+
+    std::vector<model_cache_item> m_items;
+    std::vector<model_cache_track> m_tracks;
+    std::vector<char> m_strings;
+    std::unordered_map<std::string, uint32_t> m_string_index;
+};
+
+class model_cache_view {
+public:
+    // Checks the image and every offset in it; false leaves the view unusable
+    bool open(const void* data, size_t size) {
+        m_data = nullptr;
+        if (!data || size < sizeof(model_cache_header)) return false;
+        const char* base = static_cast<const char*>(data);
+        const model_cache_header& h = *reinterpret_cast<const model_cache_header*>(base);
+        if (memcmp(h.magic, "AAGM", 4) != 0 || h.version != model_cache_version) return false;
+        if (h.header_size != sizeof(model_cache_header) || h.file_size != size) return false;
+        if (!in_bounds(h.items_offset, (uint64_t)h.item_count * sizeof(model_cache_item), size)) return false;
+        if (!in_bounds(h.tracks_offset, (uint64_t)h.track_count * sizeof(model_cache_track), size)) return false;
+        if (!in_bounds(h.strings_offset, h.strings_size, size) || h.strings_size == 0) return false;
+        if ((h.items_offset | h.tracks_offset) & 7) return false;
+        if (base[h.strings_offset] != '\0' || base[h.strings_offset + h.strings_size - 1] != '\0') return false;
+
+        const auto* items = reinterpret_cast<const model_cache_item*>(base + h.items_offset);
+        const auto* tracks = reinterpret_cast<const model_cache_track*>(base + h.tracks_offset);
+        const uint64_t strings = h.strings_size;
+        for (uint32_t i = 0; i < h.item_count; i++) {
+            const model_cache_item& it = items[i];
+            const uint32_t text[] = { it.display_name, it.folder_name, it.sort_key, it.path,
+                                      it.artist, it.album, it.genre, it.year };
+            for (uint32_t offset : text) {
+                if (offset >= strings) return false;
+            }
+            if ((uint64_t)it.first_track + it.track_count > h.track_count) return false;
+            if (it.track_count > 0 && it.representative >= it.track_count) return false;
+        }
+        for (uint32_t t = 0; t < h.track_count; t++) {
+            if (tracks[t].directory >= strings || tracks[t].file_name >= strings) return false;
+        }
+
+        m_data = base;
+        m_header = &h;
+        m_items = items;
+        m_tracks = tracks;
+        return true;
+    }
+
+    bool is_open() const { return m_data != nullptr; }
+    const model_cache_header& header() const { return *m_header; }
+    const model_cache_item& item(size_t i) const { return m_items[i]; }
+    const model_cache_track& track(size_t i) const { return m_tracks[i]; }
+    const char* string(uint32_t offset) const { return m_data + m_header->strings_offset + offset; }
+
+private:
+    static bool in_bounds(uint64_t offset, uint64_t length, uint64_t size) {
+        return offset <= size && length <= size - offset;
+    }
+
+    const char* m_data = nullptr;
+    const model_cache_header* m_header = nullptr;
+    const model_cache_item* m_items = nullptr;
+    const model_cache_track* m_tracks = nullptr;
+};
+
+} // namespace albumart_grid
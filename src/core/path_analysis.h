@@ -0,0 +1,136 @@
+#pragma once
+
+// Per-directory path analysis for the grid model.
+//
+// The parent folder name, the disc number implied by a CD1 / Disc 2 style
+// folder and the album root above such a folder (Album\CD1\track.flac ->
+// Album) only depend on the directory a track lives in. directory_cache works
+// them out once per directory; every track of that directory then gets the
+// shared answer through a single lookup of its directory prefix instead of
+// walking its full path again.
+//
+// Lookups may come from several grouping workers at once, so the cache is
+// split into independently locked shards like string_pool. Entries are never
+// removed: returned references stay valid for as long as the cache lives.
+//
+// No foobar2000 SDK dependency.
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "string_pool.h"
+
+namespace albumart_grid {
+
+// Views into the directory text held by the cache (or by the caller for
+// analyze_directory); none of them is NUL-terminated.
+struct directory_info {
+    std::string_view folder_name;      // last directory segment, empty if there is none
+    std::string_view album_root_path;  // disc folders only: the album folder, no trailing separator
+    std::string_view album_root_name;  // disc folders only: name of the album folder
+    int disc = 0;                      // from the folder name, 0 if it does not look like a disc folder
+    bool folder_has_parent = false;    // a separator precedes folder_name (i.e. not "C:")
+
+    bool has_album_root() const { return !album_root_path.empty(); }
+};
+
+inline bool is_path_separator(char c) { return c == '\\' || c == '/'; }
+
+// Length of the directory part of path, including its last separator; 0 if
+// there is none. Backslashes win over forward slashes, as in the callers that
+// used strrchr() for '\\' first.
+inline size_t directory_prefix_length(const char* path) {
+    if (!path) return 0;
+    const char* last = strrchr(path, '\\');
+    if (!last) last = strrchr(path, '/');
+    return last ? (size_t)(last - path) + 1 : 0;
+}
+
+// Digits of the first number anywhere in s ("CD 2" -> 2), 0 if none
+inline int parse_first_int(std::string_view s) {
+    size_t i = 0;
+    while (i < s.size() && !std::isdigit((unsigned char)s[i])) ++i;
+    int out = 0;
+    for (; i < s.size() && std::isdigit((unsigned char)s[i]); ++i) out = out * 10 + (s[i] - '0');
+    return out;
+}
+
+// Heuristic: only a folder naming a disc, disk or CD counts as a disc folder
+inline bool has_disc_marker(std::string_view folder) {
+    std::string upper;
+    upper.reserve(folder.size());
+    for (unsigned char c : folder) upper.push_back((char)std::toupper(c));
+    return upper.find("DISC") != std::string::npos ||
+           upper.find("DISK") != std::string::npos ||
+           upper.find("CD") != std::string::npos;
+}
+
+// dir is a directory prefix as measured by directory_prefix_length()
+inline directory_info analyze_directory(const char* dir, size_t length) {
+    directory_info out;
+    if (length < 2) return out;  // no directory, or the path starts with its only separator
+
+    const char* last_slash = dir + length - 1;
+    const char* start = last_slash - 1;
+    while (start > dir && !is_path_separator(*start)) --start;
+    out.folder_has_parent = is_path_separator(*start);
+    if (out.folder_has_parent) ++start;
+    out.folder_name = std::string_view(start, last_slash - start);
+
+    if (!out.folder_name.empty() && has_disc_marker(out.folder_name)) {
+        out.disc = parse_first_int(out.folder_name);
+    }
+
+    // ...\Album\CD1\ - the album root is the segment above the disc folder
+    if (out.disc > 0 && out.folder_has_parent) {
+        const char* disc_slash = start - 1;
+        if (disc_slash > dir) {
+            const char* album_slash = disc_slash - 1;
+            while (album_slash > dir && !is_path_separator(*album_slash)) --album_slash;
+            const char* name_start = is_path_separator(*album_slash) ? album_slash + 1 : dir;
+            if (disc_slash > name_start) {
+                out.album_root_name = std::string_view(name_start, disc_slash - name_start);
+                out.album_root_path = std::string_view(dir, disc_slash - dir);
+            }
+        }
+    }
+    return out;
+}
+
+class directory_cache {
+public:
+    directory_cache() = default;
+    directory_cache(const directory_cache&) = delete;
+    directory_cache& operator=(const directory_cache&) = delete;
+
+    // Analysis of the directory containing path (a file path, not a directory)
+    const directory_info& lookup(const char* path) {
+        const size_t length = directory_prefix_length(path);
+        const std::string_view key(length ? path : "", length);
+        shard& sh = m_shards[std::hash<std::string_view>()(key) % shard_count];
+        std::lock_guard<std::mutex> lock(sh.sync);
+        auto found = sh.directories.find(key);
+        if (found == sh.directories.end()) {
+            const char* dir = sh.arena.copy(key.data(), length);
+            found = sh.directories.emplace(std::string_view(dir, length), analyze_directory(dir, length)).first;
+        }
+        return found->second;
+    }
+
+private:
+    static const size_t shard_count = 16;
+    struct shard {
+        std::mutex sync;
+        string_arena arena;
+        std::unordered_map<std::string_view, directory_info> directories;  // keys and infos view into arena
+    };
+    shard m_shards[shard_count];
+};
+
+} // namespace albumart_grid
@@ -0,0 +1,180 @@
+#pragma once
+
+// MSD radix sort over binary sort keys.
+//
+// Keys are byte strings compared like memcmp, with a key that is a prefix of
+// another ordering first (the order of std::string::compare). They live back
+// to back in one buffer, key i being bytes [offsets[i], offsets[i + 1]), so
+// the sort walks contiguous memory instead of chasing item pointers.
+//
+// sort_keys() returns the key indices in ascending key order. The sort is
+// stable: equal keys keep their input order. Byte positions shared by a whole
+// bucket (e.g. a common prefix) are skipped without moving anything, and small
+// buckets finish with an insertion sort.
+//
+// sort_keys_parallel() gives the same order. It splits the keys into buckets on
+// the calling thread until none is bigger than a fair share of the work, then
+// sorts the buckets on a few workers (parallel_for_chunks). Buckets own disjoint
+// slices of the output and of the scratch buffer, so the workers share nothing.
+// With one thread, or fewer than two tasks' worth of keys (2 * min_task_size), it
+// is sort_keys().
+//
+// No foobar2000 SDK dependency.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "grouping_engine.h"
+
+namespace albumart_grid {
+
+class radix_key_sorter {
+public:
+    radix_key_sorter(const unsigned char* bytes, const uint32_t* offsets, size_t count)
+        : m_bytes(bytes), m_offsets(offsets), m_count(count) {}
+
+    std::vector<uint32_t> sort_keys() {
+        std::vector<uint32_t> order = start_order();
+        if (m_count > 1) sort_range(order.data(), order.data() + m_count, 0);
+        return order;
+    }
+
+    // max_threads 0 = std::thread::hardware_concurrency(), else at most this many
+    std::vector<uint32_t> sort_keys_parallel(unsigned max_threads = 0) {
+        std::vector<uint32_t> order = start_order();
+        const unsigned threads = grouping_thread_count(m_count / min_task_size, max_threads);
+        if (threads <= 1) {
+            if (m_count > 1) sort_range(order.data(), order.data() + m_count, 0);
+            return order;
+        }
+
+        // Split until every bucket is a fair share; a few per worker evens out the load
+        const size_t fair = m_count / (threads * 4);
+        const size_t share = fair > min_task_size ? fair : min_task_size;
+        std::vector<task> tasks, pending{ task{ order.data(), order.data() + m_count, 0 } };
+        while (!pending.empty()) {
+            task t = pending.back();
+            pending.pop_back();
+            if ((size_t)(t.last - t.first) <= share) {
+                tasks.push_back(t);
+                continue;
+            }
+            size_t start[257], count[257];
+            if (!partition(t.first, t.last, t.depth, start, count)) continue;
+            for (unsigned b = 1; b < 257; b++) {
+                if (count[b] > 1) pending.push_back(task{ t.first + start[b], t.first + start[b] + count[b], t.depth + 1 });
+            }
+        }
+
+        std::sort(tasks.begin(), tasks.end(), [](const task& a, const task& b) {
+            return a.last - a.first > b.last - b.first;  // biggest first
+        });
+        parallel_for_chunks(tasks.size(), 1, threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) sort_range(tasks[i].first, tasks[i].last, tasks[i].depth);
+        });
+        return order;
+    }
+
+private:
+    static const size_t insertion_threshold = 24;
+    static const size_t min_task_size = 4096;
+
+    struct task {
+        uint32_t* first;
+        uint32_t* last;
+        size_t depth;
+    };
+
+    std::vector<uint32_t> start_order() {
+        std::vector<uint32_t> order(m_count);
+        for (size_t i = 0; i < m_count; i++) order[i] = (uint32_t)i;
+        m_scratch.resize(m_count);
+        m_base = order.data();
+        return order;
+    }
+
+    size_t key_length(uint32_t key) const { return m_offsets[key + 1] - m_offsets[key]; }
+
+    // 0 once the key has ended, byte + 1 before that
+    unsigned bucket_of(uint32_t key, size_t depth) const {
+        return depth < key_length(key) ? (unsigned)m_bytes[m_offsets[key] + depth] + 1 : 0;
+    }
+
+    // Compares the keys from depth on (the bytes before are known to be equal)
+    bool less_from(uint32_t a, uint32_t b, size_t depth) const {
+        const size_t len_a = key_length(a) - depth, len_b = key_length(b) - depth;
+        const size_t len = len_a < len_b ? len_a : len_b;
+        const int c = len ? memcmp(m_bytes + m_offsets[a] + depth, m_bytes + m_offsets[b] + depth, len) : 0;
+        return c != 0 ? c < 0 : len_a < len_b;
+    }
+
+    void insertion_sort(uint32_t* first, uint32_t* last, size_t depth) const {
+        for (uint32_t* i = first + 1; i < last; ++i) {
+            const uint32_t key = *i;
+            uint32_t* j = i;
+            while (j > first && less_from(key, j[-1], depth)) {
+                *j = j[-1];
+                --j;
+            }
+            *j = key;
+        }
+    }
+
+    // Distributes [first, last) by the byte at depth, after skipping the bytes the
+    // whole range shares (depth is advanced past them). Bucket b then occupies
+    // [first + start[b], first + start[b] + count[b]); bucket 0 holds keys that ended
+    // here, which are equal and stay in input order. False if every key ended, i.e.
+    // the range is already in order.
+    bool partition(uint32_t* first, uint32_t* last, size_t& depth, size_t start[257], size_t count[257]) {
+        const size_t n = (size_t)(last - first);
+        for (;;) {
+            memset(count, 0, 257 * sizeof(size_t));
+            for (const uint32_t* p = first; p < last; ++p) count[bucket_of(*p, depth)]++;
+            if (count[0] == n) return false;  // every key ended here - all equal
+
+            size_t filled = 0;
+            for (unsigned b = 0; b < 257 && filled == 0; b++) {
+                if (count[b] == n) filled = b;
+            }
+            if (filled == 0) break;
+            depth++;  // one shared byte, nothing to move
+        }
+
+        size_t sum = 0;
+        for (unsigned b = 0; b < 257; b++) {
+            start[b] = sum;
+            sum += count[b];
+        }
+        uint32_t* scratch = m_scratch.data() + (first - m_base);  // this range's own slice
+        size_t next[257];
+        memcpy(next, start, sizeof(next));
+        for (const uint32_t* p = first; p < last; ++p) scratch[next[bucket_of(*p, depth)]++] = *p;
+        memcpy(first, scratch, n * sizeof(uint32_t));
+        return true;
+    }
+
+    // All keys in [first, last) share their first depth bytes
+    void sort_range(uint32_t* first, uint32_t* last, size_t depth) {
+        const size_t n = (size_t)(last - first);
+        if (n < 2) return;
+        if (n <= insertion_threshold) {
+            insertion_sort(first, last, depth);
+            return;
+        }
+        size_t start[257], count[257];
+        if (!partition(first, last, depth, start, count)) return;
+        for (unsigned b = 1; b < 257; b++) {
+            if (count[b] > 1) sort_range(first + start[b], first + start[b] + count[b], depth + 1);
+        }
+    }
+
+    const unsigned char* m_bytes;
+    const uint32_t* m_offsets;
+    size_t m_count;
+    std::vector<uint32_t> m_scratch;
+    const uint32_t* m_base = nullptr;  // start of the order being sorted; m_scratch mirrors it
+};
+
+} // namespace albumart_grid
@@ -0,0 +1,419 @@
+#pragma once
+
+// Separable resampler for premultiplied 32-bit pixels (4 bytes per pixel in
+// any channel order, alpha last, e.g. GDI+ PARGB's B, G, R, A in memory).
+//
+// resample() filters rows into an intermediate image of the target width,
+// then filters its columns into the target. Each output pixel has its own
+// list of source taps and 14-bit fixed-point weights summing to exactly one,
+// so a flat colour stays flat. Two filters: area (every source pixel weighted
+// by how much of the output pixel it covers) and Lanczos-3, widened by the
+// reduction factor when shrinking. resample_thumbnail() area-averages down to
+// twice the target first when the source is further away than that, so the
+// Lanczos taps stay few however large the cover.
+//
+// The inner loops exist as scalar, SSE2 and AVX2 code, picked at runtime
+// (best_resample_isa()). They use the same integer arithmetic, so all three
+// give bit-identical results.
+//
+// No foobar2000 SDK dependency.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define ALBUMART_RESAMPLE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ALBUMART_TARGET_AVX2
+#else
+#define ALBUMART_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define ALBUMART_RESAMPLE_X86 0
+#endif
+
+namespace albumart_grid {
+
+struct pixel_view {
+    const uint8_t* pixels;
+    int width;
+    int height;
+    ptrdiff_t stride;  // bytes from one row to the next
+
+    const uint8_t* row(int y) const { return pixels + y * stride; }
+};
+
+struct pixel_target {
+    uint8_t* pixels;
+    int width;
+    int height;
+    ptrdiff_t stride;
+
+    uint8_t* row(int y) const { return pixels + y * stride; }
+};
+
+enum class resample_filter { area, lanczos3 };
+enum class resample_isa { scalar, sse2, avx2 };
+
+inline resample_isa detect_resample_isa() {
+#if ALBUMART_RESAMPLE_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        const bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        if (os_avx && (info[1] & (1 << 5))) return resample_isa::avx2;
+    }
+    return resample_isa::sse2;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? resample_isa::avx2 : resample_isa::sse2;
+#endif
+#else
+    return resample_isa::scalar;
+#endif
+}
+
+inline resample_isa best_resample_isa() {
+    static const resample_isa isa = detect_resample_isa();
+    return isa;
+}
+
+namespace resample_detail {
+
+static const int weight_bits = 14;
+static const int weight_one = 1 << weight_bits;
+
+// Taps of every output pixel along one axis: output i reads source pixels
+// [start, start + count) with weights[first, first + count)
+struct contributions {
+    struct tap_range {
+        int start;
+        int count;
+        size_t first;
+    };
+    std::vector<tap_range> ranges;
+    std::vector<int16_t> weights;
+};
+
+inline double lanczos3(double x) {
+    x = std::fabs(x);
+    if (x < 1e-9) return 1.0;
+    if (x >= 3.0) return 0.0;
+    const double pi_x = 3.14159265358979323846 * x;
+    return 3.0 * std::sin(pi_x) * std::sin(pi_x / 3.0) / (pi_x * pi_x);
+}
+
+inline contributions make_contributions(int source, int target, resample_filter filter) {
+    contributions out;
+    out.ranges.resize(target);
+    const double scale = (double)source / target;
+    const double widen = scale > 1.0 ? scale : 1.0;
+    const double support = filter == resample_filter::area ? scale / 2 : 3.0 * widen;
+    std::vector<double> weights;
+    for (int i = 0; i < target; i++) {
+        const double center = (i + 0.5) * scale;
+        int left = (int)std::floor(center - support);
+        int right = (int)std::ceil(center + support);
+        left = std::max(left, 0);
+        right = std::min(right, source);
+        weights.clear();
+        double sum = 0;
+        for (int j = left; j < right; j++) {
+            double w;
+            if (filter == resample_filter::area) {
+                const double lo = std::max((double)j, center - scale / 2), hi = std::min(j + 1.0, center + scale / 2);
+                w = hi > lo ? hi - lo : 0.0;
+            } else {
+                w = lanczos3((j + 0.5 - center) / widen);
+            }
+            weights.push_back(w);
+            sum += w;
+        }
+        // Trim taps that add nothing
+        size_t lo = 0, hi = weights.size();
+        while (lo < hi && weights[lo] == 0.0) lo++;
+        while (hi > lo && weights[hi - 1] == 0.0) hi--;
+        contributions::tap_range& range = out.ranges[i];
+        range.first = out.weights.size();
+        if (lo == hi || sum == 0.0) {
+            range.start = std::min(std::max((int)center, 0), source - 1);
+            range.count = 1;
+            out.weights.push_back((int16_t)weight_one);
+            continue;
+        }
+        range.start = left + (int)lo;
+        range.count = (int)(hi - lo);
+        int total = 0;
+        size_t biggest = range.first;
+        for (size_t k = lo; k < hi; k++) {
+            const int q = (int)std::lround(weights[k] / sum * weight_one);
+            out.weights.push_back((int16_t)q);
+            total += q;
+            if (q > out.weights[biggest]) biggest = out.weights.size() - 1;
+        }
+        out.weights[biggest] = (int16_t)(out.weights[biggest] + weight_one - total);  // sum exactly one
+    }
+    return out;
+}
+
+inline uint8_t clamp_pixel(int32_t acc) {
+    acc >>= weight_bits;
+    return (uint8_t)(acc < 0 ? 0 : acc > 255 ? 255 : acc);
+}
+
+// --- scalar ---------------------------------------------------------------
+
+inline void rows_scalar(const pixel_view& src, const pixel_target& dst, const contributions& c) {
+    for (int y = 0; y < dst.height; y++) {
+        const uint8_t* in = src.row(y);
+        uint8_t* out = dst.row(y);
+        for (int x = 0; x < dst.width; x++) {
+            const contributions::tap_range& r = c.ranges[x];
+            const int16_t* w = c.weights.data() + r.first;
+            int32_t acc[4] = { 1 << (weight_bits - 1), 1 << (weight_bits - 1), 1 << (weight_bits - 1), 1 << (weight_bits - 1) };
+            for (int k = 0; k < r.count; k++) {
+                const uint8_t* p = in + (size_t)(r.start + k) * 4;
+                for (int ch = 0; ch < 4; ch++) acc[ch] += p[ch] * w[k];
+            }
+            for (int ch = 0; ch < 4; ch++) out[x * 4 + ch] = clamp_pixel(acc[ch]);
+        }
+    }
+}
+
+// Columns of pixels [x_from, dst.width) of output row y
+inline void column_scalar(const pixel_view& src, const pixel_target& dst, const contributions& c, int y, int x_from) {
+    const contributions::tap_range& r = c.ranges[y];
+    const int16_t* w = c.weights.data() + r.first;
+    uint8_t* out = dst.row(y);
+    for (int i = x_from * 4; i < dst.width * 4; i++) {
+        int32_t acc = 1 << (weight_bits - 1);
+        for (int k = 0; k < r.count; k++) acc += src.row(r.start + k)[i] * w[k];
+        out[i] = clamp_pixel(acc);
+    }
+}
+
+inline void columns_scalar(const pixel_view& src, const pixel_target& dst, const contributions& c) {
+    for (int y = 0; y < dst.height; y++) column_scalar(src, dst, c, y, 0);
+}
+
+#if ALBUMART_RESAMPLE_X86
+
+// Two 16-bit weights side by side, as _mm_madd_epi16 pairs them
+inline int weight_pair(int16_t first, int16_t second) {
+    return (int)((uint32_t)(uint16_t)first | (uint32_t)(uint16_t)second << 16);
+}
+
+// --- SSE2 -----------------------------------------------------------------
+
+inline void rows_sse2(const pixel_view& src, const pixel_target& dst, const contributions& c) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int y = 0; y < dst.height; y++) {
+        const uint8_t* in = src.row(y);
+        uint8_t* out = dst.row(y);
+        for (int x = 0; x < dst.width; x++) {
+            const contributions::tap_range& r = c.ranges[x];
+            const int16_t* w = c.weights.data() + r.first;
+            const uint8_t* p = in + (size_t)r.start * 4;
+            __m128i acc = _mm_set1_epi32(1 << (weight_bits - 1));
+            int k = 0;
+            for (; k + 2 <= r.count; k += 2) {
+                const __m128i two = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + k * 4)), zero);
+                const __m128i pairs = _mm_unpacklo_epi16(two, _mm_srli_si128(two, 8));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(pairs, _mm_set1_epi32(weight_pair(w[k], w[k + 1]))));
+            }
+            if (k < r.count) {
+                int32_t last;
+                memcpy(&last, p + k * 4, 4);
+                const __m128i one = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(last), zero), zero);
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(one, _mm_set1_epi32(weight_pair(w[k], 0))));
+            }
+            acc = _mm_srai_epi32(acc, weight_bits);
+            acc = _mm_packus_epi16(_mm_packs_epi32(acc, acc), zero);
+            const int32_t pixel = _mm_cvtsi128_si32(acc);
+            memcpy(out + x * 4, &pixel, 4);
+        }
+    }
+}
+
+inline void columns_sse2(const pixel_view& src, const pixel_target& dst, const contributions& c) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int y = 0; y < dst.height; y++) {
+        const contributions::tap_range& r = c.ranges[y];
+        const int16_t* w = c.weights.data() + r.first;
+        uint8_t* out = dst.row(y);
+        int x = 0;
+        for (; x + 4 <= dst.width; x += 4) {
+            __m128i acc0 = _mm_set1_epi32(1 << (weight_bits - 1)), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+            for (int k = 0; k < r.count; k += 2) {
+                const __m128i a = _mm_loadu_si128((const __m128i*)(src.row(r.start + k) + x * 4));
+                const __m128i b = k + 1 < r.count ? _mm_loadu_si128((const __m128i*)(src.row(r.start + k + 1) + x * 4)) : zero;
+                const __m128i weights = _mm_set1_epi32(weight_pair(w[k], k + 1 < r.count ? w[k + 1] : 0));
+                const __m128i a_lo = _mm_unpacklo_epi8(a, zero), a_hi = _mm_unpackhi_epi8(a, zero);
+                const __m128i b_lo = _mm_unpacklo_epi8(b, zero), b_hi = _mm_unpackhi_epi8(b, zero);
+                acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(a_lo, b_lo), weights));
+                acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(a_lo, b_lo), weights));
+                acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(a_hi, b_hi), weights));
+                acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(a_hi, b_hi), weights));
+            }
+            const __m128i lo = _mm_packs_epi32(_mm_srai_epi32(acc0, weight_bits), _mm_srai_epi32(acc1, weight_bits));
+            const __m128i hi = _mm_packs_epi32(_mm_srai_epi32(acc2, weight_bits), _mm_srai_epi32(acc3, weight_bits));
+            _mm_storeu_si128((__m128i*)(out + x * 4), _mm_packus_epi16(lo, hi));
+        }
+        if (x < dst.width) column_scalar(src, dst, c, y, x);
+    }
+}
+
+// --- AVX2 -----------------------------------------------------------------
+
+ALBUMART_TARGET_AVX2 inline void rows_avx2(const pixel_view& src, const pixel_target& dst, const contributions& c) {
+    const __m128i zero = _mm_setzero_si128();
+    // Per 128-bit lane: pixel a's channels at 16-bit slots 0-3, b's at 4-7 -> a0 b0 a1 b1 ...
+    const __m256i interleave = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+                                                0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+    for (int y = 0; y < dst.height; y++) {
+        const uint8_t* in = src.row(y);
+        uint8_t* out = dst.row(y);
+        for (int x = 0; x < dst.width; x++) {
+            const contributions::tap_range& r = c.ranges[x];
+            const int16_t* w = c.weights.data() + r.first;
+            const uint8_t* p = in + (size_t)r.start * 4;
+            __m256i acc4 = _mm256_setzero_si256();
+            int k = 0;
+            for (; k + 4 <= r.count; k += 4) {
+                const __m256i four = _mm256_shuffle_epi8(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(p + k * 4))), interleave);
+                const __m256i weights = _mm256_setr_epi32(weight_pair(w[k], w[k + 1]), weight_pair(w[k], w[k + 1]),
+                                                          weight_pair(w[k], w[k + 1]), weight_pair(w[k], w[k + 1]),
+                                                          weight_pair(w[k + 2], w[k + 3]), weight_pair(w[k + 2], w[k + 3]),
+                                                          weight_pair(w[k + 2], w[k + 3]), weight_pair(w[k + 2], w[k + 3]));
+                acc4 = _mm256_add_epi32(acc4, _mm256_madd_epi16(four, weights));
+            }
+            __m128i acc = _mm_add_epi32(_mm_set1_epi32(1 << (weight_bits - 1)),
+                                        _mm_add_epi32(_mm256_castsi256_si128(acc4), _mm256_extracti128_si256(acc4, 1)));
+            for (; k + 2 <= r.count; k += 2) {
+                const __m128i two = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(p + k * 4)), zero);
+                const __m128i pairs = _mm_unpacklo_epi16(two, _mm_srli_si128(two, 8));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(pairs, _mm_set1_epi32(weight_pair(w[k], w[k + 1]))));
+            }
+            if (k < r.count) {
+                int32_t last;
+                memcpy(&last, p + k * 4, 4);
+                const __m128i one = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(last), zero), zero);
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(one, _mm_set1_epi32(weight_pair(w[k], 0))));
+            }
+            acc = _mm_srai_epi32(acc, weight_bits);
+            acc = _mm_packus_epi16(_mm_packs_epi32(acc, acc), zero);
+            const int32_t pixel = _mm_cvtsi128_si32(acc);
+            memcpy(out + x * 4, &pixel, 4);
+        }
+    }
+}
+
+ALBUMART_TARGET_AVX2 inline void columns_avx2(const pixel_view& src, const pixel_target& dst, const contributions& c) {
+    const __m256i zero = _mm256_setzero_si256();
+    for (int y = 0; y < dst.height; y++) {
+        const contributions::tap_range& r = c.ranges[y];
+        const int16_t* w = c.weights.data() + r.first;
+        uint8_t* out = dst.row(y);
+        int x = 0;
+        // Unpacking works per 128-bit lane, so acc0 holds pixels 0 and 4, acc1 1 and 5,
+        // and so on; packing restores the order
+        for (; x + 8 <= dst.width; x += 8) {
+            __m256i acc0 = _mm256_set1_epi32(1 << (weight_bits - 1)), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+            for (int k = 0; k < r.count; k += 2) {
+                const __m256i a = _mm256_loadu_si256((const __m256i*)(src.row(r.start + k) + x * 4));
+                const __m256i b = k + 1 < r.count ? _mm256_loadu_si256((const __m256i*)(src.row(r.start + k + 1) + x * 4)) : zero;
+                const __m256i weights = _mm256_set1_epi32(weight_pair(w[k], k + 1 < r.count ? w[k + 1] : 0));
+                const __m256i a_lo = _mm256_unpacklo_epi8(a, zero), a_hi = _mm256_unpackhi_epi8(a, zero);
+                const __m256i b_lo = _mm256_unpacklo_epi8(b, zero), b_hi = _mm256_unpackhi_epi8(b, zero);
+                acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a_lo, b_lo), weights));
+                acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a_lo, b_lo), weights));
+                acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(a_hi, b_hi), weights));
+                acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(a_hi, b_hi), weights));
+            }
+            const __m256i lo = _mm256_packs_epi32(_mm256_srai_epi32(acc0, weight_bits), _mm256_srai_epi32(acc1, weight_bits));
+            const __m256i hi = _mm256_packs_epi32(_mm256_srai_epi32(acc2, weight_bits), _mm256_srai_epi32(acc3, weight_bits));
+            _mm256_storeu_si256((__m256i*)(out + x * 4), _mm256_packus_epi16(lo, hi));
+        }
+        if (x < dst.width) column_scalar(src, dst, c, y, x);
+    }
+}
+
+#endif
+
+// Lanczos lobes can push a colour channel above alpha; premultiplied pixels must not
+inline void clamp_to_alpha(const pixel_target& dst) {
+    for (int y = 0; y < dst.height; y++) {
+        uint8_t* p = dst.row(y);
+        for (int x = 0; x < dst.width; x++, p += 4) {
+            const uint8_t a = p[3];
+            if (a == 255) continue;
+            for (int ch = 0; ch < 3; ch++) {
+                if (p[ch] > a) p[ch] = a;
+            }
+        }
+    }
+}
+
+} // namespace resample_detail
+
+// Resamples all of src into all of dst
+inline void resample(const pixel_view& src, const pixel_target& dst, resample_filter filter,
+                     resample_isa isa = best_resample_isa()) {
+    using namespace resample_detail;
+    if (src.width <= 0 || src.height <= 0 || dst.width <= 0 || dst.height <= 0) return;
+    const contributions horizontal = make_contributions(src.width, dst.width, filter);
+    contributions vertical = make_contributions(src.height, dst.height, filter);
+
+    // Only the source rows some output row reads go through the first pass
+    int first_row = src.height, last_row = 0;
+    for (const contributions::tap_range& r : vertical.ranges) {
+        first_row = std::min(first_row, r.start);
+        last_row = std::max(last_row, r.start + r.count);
+    }
+    for (contributions::tap_range& r : vertical.ranges) r.start -= first_row;
+    std::vector<uint8_t> rows((size_t)dst.width * 4 * (last_row - first_row));
+    const pixel_view row_src = { src.row(first_row), src.width, last_row - first_row, src.stride };
+    const pixel_target row_dst = { rows.data(), dst.width, last_row - first_row, (ptrdiff_t)dst.width * 4 };
+    const pixel_view column_src = { rows.data(), dst.width, last_row - first_row, row_dst.stride };
+
+#if ALBUMART_RESAMPLE_X86
+    if (isa == resample_isa::avx2) {
+        rows_avx2(row_src, row_dst, horizontal);
+        columns_avx2(column_src, dst, vertical);
+    } else if (isa == resample_isa::sse2) {
+        rows_sse2(row_src, row_dst, horizontal);
+        columns_sse2(column_src, dst, vertical);
+    } else
+#endif
+    {
+        rows_scalar(row_src, row_dst, horizontal);
+        columns_scalar(column_src, dst, vertical);
+    }
+    if (filter == resample_filter::lanczos3) clamp_to_alpha(dst);
+}
+
+// Thumbnail quality: sources more than three times the target are area-averaged
+// down to twice the target, then everything goes through Lanczos-3
+inline void resample_thumbnail(const pixel_view& src, const pixel_target& dst, resample_isa isa = best_resample_isa()) {
+    if (src.width < dst.width * 3 || src.height < dst.height * 3) {
+        resample(src, dst, resample_filter::lanczos3, isa);
+        return;
+    }
+    const int mid_width = dst.width * 2, mid_height = dst.height * 2;
+    std::vector<uint8_t> mid((size_t)mid_width * mid_height * 4);
+    const pixel_target mid_dst = { mid.data(), mid_width, mid_height, (ptrdiff_t)mid_width * 4 };
+    resample(src, mid_dst, resample_filter::area, isa);
+    const pixel_view mid_src = { mid.data(), mid_width, mid_height, (ptrdiff_t)mid_width * 4 };
+    resample(mid_src, dst, resample_filter::lanczos3, isa);
+}
+
+} // namespace albumart_grid
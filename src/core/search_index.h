@@ -0,0 +1,154 @@
+#pragma once
+
+// Substring search over the grid items' text.
+//
+// Every entry is one pre-folded text (the caller folds case the same way for
+// entries and queries). The texts live back to back in one buffer, each
+// followed by a NUL, so a scan walks contiguous memory without allocating.
+//
+// Queries of three bytes or more go through a trigram index: the posting
+// lists of the query's trigrams are intersected, smallest first, and only the
+// entries left over are checked for the whole query. Shorter queries scan.
+//
+// Entries are only ever appended. An entry carries an opaque owner tag; the
+// caller tells whether an entry is still current by comparing the tag, and
+// rebuilds the index once too many entries went stale. revision() changes with
+// every add() and clear(), so earlier hits can be checked for still applying.
+//
+// A const index may be searched from other threads; find() can be cancelled.
+//
+// No foobar2000 SDK dependency.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace albumart_grid {
+
+class search_index {
+public:
+    static const uint32_t no_entry = UINT32_MAX;
+
+    void clear() {
+        m_text.clear();
+        m_offsets.clear();
+        m_owners.clear();
+        m_postings.clear();
+        m_revision++;
+    }
+
+    size_t size() const { return m_owners.size(); }
+    uint64_t revision() const { return m_revision; }
+    const void* owner(uint32_t id) const { return id < m_owners.size() ? m_owners[id] : nullptr; }
+
+    std::string_view text(uint32_t id) const {
+        return std::string_view(m_text.data() + m_offsets[id], m_offsets[id + 1] - m_offsets[id] - 1);
+    }
+
+    uint32_t add(const void* owner, std::string_view folded) {
+        if (m_offsets.empty()) m_offsets.push_back(0);
+        const uint32_t id = (uint32_t)m_owners.size();
+        m_revision++;
+        m_owners.push_back(owner);
+        m_text.append(folded.data(), folded.size());
+        m_text.push_back('\0');
+        m_offsets.push_back((uint32_t)m_text.size());
+        for (size_t i = 0; i + 3 <= folded.size(); i++) {
+            std::vector<uint32_t>& list = m_postings[trigram(folded.data() + i)];
+            if (list.empty() || list.back() != id) list.push_back(id);  // ids only grow
+        }
+        return id;
+    }
+
+    // Entries find() has to look at for query: all of them below three bytes,
+    // otherwise at most the shortest posting list of its trigrams
+    size_t estimate_work(std::string_view query) const {
+        if (query.size() < 3) return size();
+        size_t least = size();
+        for (size_t i = 0; i + 3 <= query.size(); i++) {
+            auto found = m_postings.find(trigram(query.data() + i));
+            least = std::min(least, found == m_postings.end() ? (size_t)0 : found->second.size());
+        }
+        return least;
+    }
+
+    // Ids of the entries containing query (folded like the entries), ascending.
+    // False, with out incomplete, if cancel was set meanwhile.
+    bool find(std::string_view query, std::vector<uint32_t>& out, const std::atomic<bool>* cancel = nullptr) const {
+        out.clear();
+        if (query.empty()) return true;
+        if (query.size() < 3) {
+            for (uint32_t id = 0; id < m_owners.size(); id++) {
+                if ((id & 4095) == 0 && is_cancelled(cancel)) return false;
+                if (text(id).find(query) != std::string_view::npos) out.push_back(id);
+            }
+            return true;
+        }
+
+        std::vector<const std::vector<uint32_t>*> lists;
+        for (size_t i = 0; i + 3 <= query.size(); i++) {
+            auto found = m_postings.find(trigram(query.data() + i));
+            if (found == m_postings.end()) return true;  // some trigram occurs nowhere
+            lists.push_back(&found->second);
+        }
+        std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+            return a->size() < b->size();
+        });
+        lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+        std::vector<uint32_t> candidates(*lists[0]);
+        for (size_t l = 1; l < lists.size() && !candidates.empty(); l++) {
+            if (is_cancelled(cancel)) return false;
+            const std::vector<uint32_t>& list = *lists[l];
+            size_t kept = 0;
+            auto at = list.begin();
+            for (uint32_t id : candidates) {
+                at = std::lower_bound(at, list.end(), id);
+                if (at == list.end()) break;
+                if (*at == id) candidates[kept++] = id;
+            }
+            candidates.resize(kept);
+        }
+        if (query.size() == 3) {
+            out.swap(candidates);
+            return true;
+        }
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if ((i & 4095) == 0 && is_cancelled(cancel)) return false;
+            if (text(candidates[i]).find(query) != std::string_view::npos) out.push_back(candidates[i]);
+        }
+        return true;
+    }
+
+    // Keeps the ids whose entry contains query. For a query that extends the one
+    // ids were found for, this is the same as find() at the cost of the old hits.
+    void refine(std::string_view query, std::vector<uint32_t>& ids) const {
+        size_t kept = 0;
+        for (uint32_t id : ids) {
+            if (id < m_owners.size() && text(id).find(query) != std::string_view::npos) ids[kept++] = id;
+        }
+        ids.resize(kept);
+    }
+
+private:
+    static bool is_cancelled(const std::atomic<bool>* cancel) {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    }
+
+    static uint32_t trigram(const char* p) {
+        return (uint32_t)(unsigned char)p[0] << 16 | (uint32_t)(unsigned char)p[1] << 8 | (unsigned char)p[2];
+    }
+
+    std::string m_text;               // every entry's text, NUL after each
+    std::vector<uint32_t> m_offsets;  // entry i is [m_offsets[i], m_offsets[i + 1] - 1)
+    std::vector<const void*> m_owners;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_postings;  // trigram -> entry ids, ascending
+    uint64_t m_revision = 0;
+};
+
+} // namespace albumart_grid
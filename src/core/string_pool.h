@@ -0,0 +1,123 @@
+#pragma once
+
+// Interned, arena-backed strings for the grid model.
+//
+// A model's text fields (names, artists, genres, years, paths) repeat heavily,
+// so each distinct string is stored once in a string_pool and the model only
+// keeps pooled_string views of it. The pool carves its copies out of large
+// arena blocks: building a 40k-album model costs a few dozen allocations, and
+// dropping the pool with its model frees them all at once instead of string by
+// string.
+//
+// The pool is split into independently locked shards (picked by hash), so the
+// grouping workers can intern concurrently. pooled_string views stay valid for
+// as long as the pool lives; they must not outlive it.
+//
+// No foobar2000 SDK dependency.
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace albumart_grid {
+
+// NUL-terminated view of a pooled string. Mirrors the read-only part of
+// pfc::string8 that the grid uses.
+class pooled_string {
+public:
+    pooled_string() = default;
+
+    const char* c_str() const { return m_ptr; }
+    const char* get_ptr() const { return m_ptr; }
+    size_t length() const { return m_len; }
+    size_t get_length() const { return m_len; }
+    bool is_empty() const { return m_len == 0; }
+    bool empty() const { return m_len == 0; }
+    char operator[](size_t i) const { return m_ptr[i]; }
+    std::string_view view() const { return std::string_view(m_ptr, m_len); }
+
+    bool operator==(const char* other) const { return other && strcmp(m_ptr, other) == 0; }
+    bool operator!=(const char* other) const { return !(*this == other); }
+
+private:
+    friend class string_pool;
+    pooled_string(const char* ptr, size_t len) : m_ptr(ptr), m_len((uint32_t)len) {}
+
+    const char* m_ptr = "";
+    uint32_t m_len = 0;
+};
+
+// Bump allocator: hands out slices of large blocks, frees only as a whole
+class string_arena {
+public:
+    static const size_t block_size = 64 * 1024;
+
+    // Copies n bytes and appends a NUL
+    const char* copy(const char* s, size_t n) {
+        const size_t need = n + 1;
+        if (need > m_left) {
+            const size_t size = need > block_size / 4 ? need : block_size;  // big strings get their own block
+            m_blocks.emplace_back(new char[size]);
+            if (size != block_size) {
+                char* own = m_blocks.back().get();
+                memcpy(own, s, n);
+                own[n] = 0;
+                return own;
+            }
+            m_next = m_blocks.back().get();
+            m_left = size;
+        }
+        char* out = m_next;
+        memcpy(out, s, n);
+        out[n] = 0;
+        m_next += need;
+        m_left -= need;
+        return out;
+    }
+
+    size_t get_block_count() const { return m_blocks.size(); }
+
+private:
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char* m_next = nullptr;
+    size_t m_left = 0;
+};
+
+class string_pool {
+public:
+    string_pool() = default;
+    string_pool(const string_pool&) = delete;
+    string_pool& operator=(const string_pool&) = delete;
+
+    pooled_string intern(const char* s) { return s ? intern(s, strlen(s)) : pooled_string(); }
+
+    pooled_string intern(const char* s, size_t n) {
+        if (!s || n == 0) return pooled_string();
+        const std::string_view key(s, n);
+        shard& sh = m_shards[std::hash<std::string_view>()(key) % shard_count];
+        std::lock_guard<std::mutex> lock(sh.sync);
+        auto found = sh.strings.find(key);
+        if (found == sh.strings.end()) {
+            found = sh.strings.insert(std::string_view(sh.arena.copy(s, n), n)).first;
+        }
+        return pooled_string(found->data(), found->size());
+    }
+
+    pooled_string intern(std::string_view s) { return intern(s.data(), s.size()); }
+
+private:
+    static const size_t shard_count = 16;
+    struct shard {
+        std::mutex sync;
+        string_arena arena;
+        std::unordered_set<std::string_view> strings;  // views into arena
+    };
+    shard m_shards[shard_count];
+};
+
+} // namespace albumart_grid
@@ -0,0 +1,108 @@
+// Headless benchmark of the sharded grouping engine (src/core/grouping_engine.h)
+// against the serial std::map pass refresh_items() used before, on a synthetic
+// library standing in for the metadb. Every sharded result is checked against
+// the serial one: same groups, in the same order, with the same members.
+//
+//   grouping_bench [--tracks N] [--threads 1,2,4,8,16] [--runs R] [--quick]
+//
+// --quick (what ctest runs) uses a small library and only checks the results.
+
+#include <map>
+#include <thread>
+
+#include "grouping_engine.h"
+#include "synthetic_library.h"
+#include "test_support.h"
+
+using namespace albumart_grid;
+using namespace albumart_grid_test;
+
+namespace {
+
+struct key_less {
+    bool operator()(const std::string& a, const std::string& b) const { return group_key_less(a, b); }
+};
+
+// The keys of group_key_album, group_key_folder (no ALBUM tag case) and the
+// artist mode, computed from the synthetic tracks
+enum class mode { album, folder, artist };
+
+const char* mode_name(mode m) {
+    switch (m) {
+        case mode::album: return "album";
+        case mode::folder: return "folder";
+        case mode::artist: return "artist";
+    }
+    return "";
+}
+
+bool make_key(const synthetic_track& track, mode m, std::string& key) {
+    switch (m) {
+        case mode::album: {
+            const std::string& artist = track.album_artist.empty() ? track.artist : track.album_artist;
+            key.append(artist).append(" - ").append(track.album);
+            return true;
+        }
+        case mode::folder: key = synthetic_directory(track.path); return true;
+        case mode::artist: key = track.artist; return true;
+    }
+    return false;
+}
+
+std::vector<track_group> group_serial(const std::vector<synthetic_track>& tracks, mode m) {
+    std::map<std::string, std::vector<uint32_t>, key_less> groups;
+    std::string key;
+    for (size_t i = 0; i < tracks.size(); i++) {
+        key.clear();
+        if (make_key(tracks[i], m, key)) groups[key].push_back((uint32_t)i);
+    }
+    std::vector<track_group> out;
+    out.reserve(groups.size());
+    for (auto& group : groups) out.push_back(track_group{ group.first, std::move(group.second) });
+    return out;
+}
+
+std::vector<track_group> group_sharded(const std::vector<synthetic_track>& tracks, mode m, unsigned threads) {
+    grouping_options options;
+    options.max_threads = threads;
+    return group_tracks_sharded(tracks.size(), [&tracks, m](size_t i, std::string& key) {
+        return make_key(tracks[i], m, key);
+    }, options);
+}
+
+bool same_groups(const std::vector<track_group>& a, const std::vector<track_group>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].key != b[i].key || a[i].members != b[i].members) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = has_flag(argc, argv, "--quick");
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const size_t track_count = (size_t)strtoull(flag_value(argc, argv, "--tracks", quick ? "20000" : "400000").c_str(), nullptr, 10);
+    const std::vector<unsigned> thread_counts = number_list(flag_value(argc, argv, "--threads",
+        quick ? "1,2,4" : ("1," + std::to_string(hardware)).c_str()));
+    const int runs = quick ? 1 : atoi(flag_value(argc, argv, "--runs", "3").c_str());
+
+    const std::vector<synthetic_track> tracks = make_synthetic_library(track_count);
+    std::printf("%zu synthetic tracks, %u hardware threads\n", tracks.size(), hardware);
+
+    for (mode m : { mode::album, mode::folder, mode::artist }) {
+        std::vector<track_group> serial;
+        const double serial_ms = best_ms(runs, [&] { serial = group_serial(tracks, m); });
+        std::printf("%-7s %7zu groups  std::map serial %8.1f ms\n", mode_name(m), serial.size(), serial_ms);
+        for (unsigned threads : thread_counts) {
+            std::vector<track_group> sharded;
+            const double sharded_ms = best_ms(runs, [&] { sharded = group_sharded(tracks, m, threads); });
+            CHECK(same_groups(serial, sharded));
+            // Fewer than asked when there are fewer shards than threads
+            const unsigned used = grouping_thread_count((tracks.size() + 2047) / 2048, threads);
+            std::printf("        sharded, %2u threads (%2u used) %8.1f ms  (%.2fx)\n", threads, used, sharded_ms, serial_ms / sharded_ms);
+        }
+    }
+    return test_result("grouping_bench");
+}
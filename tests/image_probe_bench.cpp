@@ -0,0 +1,299 @@
+// Throughput of the artwork probe (src/core/image_probe.h) over a corpus of
+// covers, and what decoding at jpeg_scale_denominator() saves over a full
+// decode.
+//
+// The corpus is generated: JPEGs at real cover sizes with the segments covers
+// carry before the frame header (JFIF, a few KB of EXIF, an ICC profile, fill
+// bytes; baseline and progressive), plus PNG, GIF, BMP and WebP signatures.
+// Only the headers are real; the rest of each file is 4 KB of filler.
+// --dir adds every file under a directory, e.g. a music library.
+//
+// The decode comparison needs libjpeg (ALBUMART_HAVE_LIBJPEG), whose DCT
+// scaling is the same technique the component gets from WIC's JPEG codec. It
+// times decode plus resample_thumbnail() to the cell, full size against 1/N,
+// and checks read_jpeg_size() and jpeg_scaled_dimension() against libjpeg
+// (on the --dir JPEGs too).
+//
+//   image_probe_bench [--dir PATH] [--runs R] [--quick]
+
+#include <filesystem>
+#include <fstream>
+
+#ifdef ALBUMART_HAVE_LIBJPEG
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+#include "image_probe.h"
+#include "resample.h"
+#include "synthetic_library.h"
+#include "test_support.h"
+
+using namespace albumart_grid;
+using namespace albumart_grid_test;
+
+namespace {
+
+struct cover {
+    std::string name;
+    std::vector<uint8_t> bytes;
+    uint32_t width = 0;   // 0 = not a JPEG
+    uint32_t height = 0;
+};
+
+void put_segment(std::vector<uint8_t>& out, uint8_t marker, const std::vector<uint8_t>& payload) {
+    out.push_back(0xFF);
+    out.push_back(marker);
+    const size_t length = payload.size() + 2;
+    out.push_back((uint8_t)(length >> 8));
+    out.push_back((uint8_t)length);
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+// Everything a cover has up to its scan; the probe never reads the entropy-coded
+// data after it
+cover make_jpeg_header(uint32_t width, uint32_t height, bool progressive, synthetic_random& random) {
+    cover c;
+    c.name = std::to_string(width) + "x" + std::to_string(height) + (progressive ? " progressive" : " baseline");
+    c.width = width;
+    c.height = height;
+    std::vector<uint8_t>& out = c.bytes;
+    out = { 0xFF, 0xD8 };
+    put_segment(out, 0xE0, { 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 72, 0, 72, 0, 0 });
+    std::vector<uint8_t> exif(random.between(200, 12000));
+    for (auto& b : exif) b = (uint8_t)random.next();
+    memcpy(exif.data(), "Exif\0\0", 6);
+    put_segment(out, 0xE1, exif);
+    if (random.between(0, 2) == 0) put_segment(out, 0xE2, std::vector<uint8_t>(3144, 0x11));  // sRGB ICC profile
+    put_segment(out, 0xDB, std::vector<uint8_t>(130, 0x20));  // two quantisation tables
+    out.push_back(0xFF);  // a fill byte before the frame header
+    put_segment(out, progressive ? 0xC2 : 0xC0,
+        { 8, (uint8_t)(height >> 8), (uint8_t)height, (uint8_t)(width >> 8), (uint8_t)width, 3, 1, 0x22, 0, 2, 0x11, 1, 3, 0x11, 1 });
+    put_segment(out, 0xC4, std::vector<uint8_t>(418, 0x01));
+    put_segment(out, 0xDA, { 3, 1, 0, 2, 0x11, 3, 0x11, 0, 63, 0 });
+    out.resize(out.size() + 4096, 0x5A);
+    out.push_back(0xFF);
+    out.push_back(0xD9);
+    return c;
+}
+
+cover make_other(const char* name, const std::vector<uint8_t>& signature, size_t size) {
+    cover c;
+    c.name = name;
+    c.bytes = signature;
+    c.bytes.resize(size, 0);
+    return c;
+}
+
+std::vector<cover> make_corpus(size_t count) {
+    static const uint32_t sides[] = { 200, 300, 500, 600, 1000, 1200, 1400, 1425, 1500, 2000, 3000 };
+    synthetic_random random(3);
+    std::vector<cover> corpus;
+    while (corpus.size() < count) {
+        const unsigned kind = random.between(0, 9);
+        if (kind == 0) {
+            corpus.push_back(make_other("png", { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' }, 4096));
+        } else if (kind == 1) {
+            const char* which[] = { "gif", "bmp", "webp" };
+            const unsigned w = random.between(0, 2);
+            corpus.push_back(make_other(which[w],
+                w == 0 ? std::vector<uint8_t>{ 'G', 'I', 'F', '8', '9', 'a' }
+                : w == 1 ? std::vector<uint8_t>{ 'B', 'M' }
+                : std::vector<uint8_t>{ 'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'E', 'B', 'P' }, 4096));
+        } else {
+            const uint32_t side = sides[random.between(0, 10)];
+            const uint32_t other = random.between(0, 4) == 0 ? side * 3 / 4 : side;
+            corpus.push_back(make_jpeg_header(side, other, random.between(0, 3) == 0, random));
+        }
+    }
+    return corpus;
+}
+
+void add_directory(std::vector<cover>& corpus, const std::string& root) {
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_regular_file(error) || it->file_size(error) > 64u << 20) continue;
+        std::ifstream file(it->path(), std::ios::binary);
+        cover c;
+        c.name = it->path().string();
+        c.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        c.width = c.height = 0;
+        corpus.push_back(std::move(c));
+    }
+}
+
+// What create_thumbnail() asks of every cover before decoding it
+struct probe_result {
+    size_t jpegs = 0;
+    size_t scaled = 0;
+};
+
+probe_result probe_all(const std::vector<cover>& corpus, uint32_t target) {
+    probe_result result;
+    for (const cover& c : corpus) {
+        if (sniff_image_format(c.bytes.data(), c.bytes.size()) != image_format::jpeg) continue;
+        result.jpegs++;
+        uint32_t width = 0, height = 0;
+        if (read_jpeg_size(c.bytes.data(), c.bytes.size(), width, height) && jpeg_scale_denominator(width, height, target) > 1) result.scaled++;
+    }
+    return result;
+}
+
+void check_generated(const std::vector<cover>& corpus) {
+    for (const cover& c : corpus) {
+        const image_format format = sniff_image_format(c.bytes.data(), c.bytes.size());
+        if (c.width == 0) {
+            CHECK(format != image_format::jpeg);
+            continue;
+        }
+        uint32_t width = 0, height = 0;
+        CHECK(format == image_format::jpeg);
+        CHECK(read_jpeg_size(c.bytes.data(), c.bytes.size(), width, height) && width == c.width && height == c.height);
+    }
+}
+
+#ifdef ALBUMART_HAVE_LIBJPEG
+// A cover-like picture: gradients with noise, so it compresses like a photo
+std::vector<uint8_t> encode_jpeg(uint32_t width, uint32_t height, bool progressive) {
+    synthetic_random random(width * 7 + height);
+    std::vector<uint8_t> rgb((size_t)width * height * 3);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t* p = &rgb[((size_t)y * width + x) * 3];
+            p[0] = (uint8_t)(x * 255 / width + random.between(0, 24));
+            p[1] = (uint8_t)(y * 255 / height + random.between(0, 24));
+            p[2] = (uint8_t)((x ^ y) & 0xFF);
+        }
+    }
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+    jpeg_mem_dest(&cinfo, &buffer, &size);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 90, TRUE);
+    if (progressive) jpeg_simple_progression(&cinfo);
+    jpeg_start_compress(&cinfo, TRUE);
+    std::vector<uint8_t> exif(4000, 0x42);
+    memcpy(exif.data(), "Exif\0\0", 6);
+    jpeg_write_marker(&cinfo, JPEG_APP0 + 1, exif.data(), (unsigned)exif.size());
+    while (cinfo.next_scanline < height) {
+        JSAMPROW row = &rgb[(size_t)cinfo.next_scanline * width * 3];
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    std::vector<uint8_t> out(buffer, buffer + size);
+    jpeg_destroy_compress(&cinfo);
+    free(buffer);
+    return out;
+}
+
+// Decodes at 1/denominator into BGRA pixels
+void decode_jpeg(const std::vector<uint8_t>& bytes, unsigned denominator, std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height) {
+    jpeg_decompress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(bytes.data()), (unsigned long)bytes.size());
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = denominator;
+    cinfo.out_color_space = JCS_EXT_BGRA;
+    jpeg_start_decompress(&cinfo);
+    width = cinfo.output_width;
+    height = cinfo.output_height;
+    pixels.resize((size_t)width * height * 4);
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW out = &pixels[(size_t)cinfo.output_scanline * width * 4];
+        jpeg_read_scanlines(&cinfo, &out, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+}
+
+// create_thumbnail() for a square cell: decode, then resample into the cell
+double thumbnail_ms(const std::vector<uint8_t>& bytes, unsigned denominator, uint32_t target, int runs, uint32_t& width, uint32_t& height) {
+    std::vector<uint8_t> pixels, cell((size_t)target * target * 4);
+    return best_ms(runs, [&] {
+        decode_jpeg(bytes, denominator, pixels, width, height);
+        const pixel_view src = { pixels.data(), (int)width, (int)height, (ptrdiff_t)width * 4 };
+        const pixel_target dst = { cell.data(), (int)target, (int)target, (ptrdiff_t)target * 4 };
+        resample_thumbnail(src, dst);
+    });
+}
+
+// Header sizes of real files against what libjpeg reads
+void check_against_libjpeg(const std::vector<cover>& corpus) {
+    size_t checked = 0;
+    for (const cover& c : corpus) {
+        if (c.width != 0 || sniff_image_format(c.bytes.data(), c.bytes.size()) != image_format::jpeg) continue;
+        jpeg_decompress_struct cinfo;
+        jpeg_error_mgr jerr;
+        cinfo.err = jpeg_std_error(&jerr);
+        jpeg_create_decompress(&cinfo);
+        jpeg_mem_src(&cinfo, const_cast<unsigned char*>(c.bytes.data()), (unsigned long)c.bytes.size());
+        uint32_t width = 0, height = 0;
+        const bool ours = read_jpeg_size(c.bytes.data(), c.bytes.size(), width, height);
+        if (jpeg_read_header(&cinfo, TRUE) == JPEG_HEADER_OK) {
+            CHECK(ours && width == cinfo.image_width && height == cinfo.image_height);
+            checked++;
+        }
+        jpeg_destroy_decompress(&cinfo);
+    }
+    if (checked) std::printf("read_jpeg_size() agrees with libjpeg on %zu files\n", checked);
+}
+
+void bench_decode(bool quick, int runs) {
+    static const uint32_t sides[] = { 500, 1000, 1400, 3000 };
+    for (uint32_t side : sides) {
+        if (quick && side > 1000) continue;
+        for (bool progressive : { false, true }) {
+            const std::vector<uint8_t> bytes = encode_jpeg(side, side, progressive);
+            uint32_t width = 0, height = 0;
+            CHECK(read_jpeg_size(bytes.data(), bytes.size(), width, height) && width == side && height == side);
+            for (uint32_t target : { 150u, 250u }) {
+                const unsigned denominator = jpeg_scale_denominator(width, height, target);
+                uint32_t full_w = 0, full_h = 0, scaled_w = 0, scaled_h = 0;
+                const double full = thumbnail_ms(bytes, 1, target, runs, full_w, full_h);
+                const double scaled = thumbnail_ms(bytes, denominator, target, runs, scaled_w, scaled_h);
+                CHECK(scaled_w == jpeg_scaled_dimension(width, denominator) && scaled_h == jpeg_scaled_dimension(height, denominator));
+                CHECK(scaled_w >= target || denominator == 1);
+                std::printf("%4ux%-4u %-11s -> %3u px: decode+resample full %7.2f ms, at 1/%u (%ux%u) %6.2f ms  %.1fx, %.0fx fewer pixels\n",
+                    side, side, progressive ? "progressive" : "baseline", target, full, denominator, scaled_w, scaled_h,
+                    scaled, full / scaled, (double)full_w * full_h / ((double)scaled_w * scaled_h));
+            }
+        }
+    }
+}
+#endif
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = has_flag(argc, argv, "--quick");
+    const int runs = quick ? 1 : atoi(flag_value(argc, argv, "--runs", "5").c_str());
+
+    std::vector<cover> corpus = make_corpus(quick ? 2000 : 20000);
+    check_generated(corpus);
+    const std::string dir = flag_value(argc, argv, "--dir", "");
+    if (!dir.empty()) add_directory(corpus, dir);
+
+    probe_result result;
+    const double ms = best_ms(runs, [&] { result = probe_all(corpus, 150); });
+    std::printf("probed %zu covers (%zu JPEG, %zu of them decodable at 1/2 or less for 150 px) in %.2f ms: %.0f ns per cover\n",
+        corpus.size(), result.jpegs, result.scaled, ms, ms * 1e6 / (double)corpus.size());
+
+#ifdef ALBUMART_HAVE_LIBJPEG
+    check_against_libjpeg(corpus);
+    bench_decode(quick, runs);
+#else
+    std::printf("built without libjpeg: no decode comparison\n");
+#endif
+    return test_result("image_probe_bench");
+}
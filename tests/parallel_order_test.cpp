@@ -0,0 +1,241 @@
+// The parallel paths against their serial references, at 1-16 threads:
+// radix_key_sorter::sort_keys_parallel() against sort_keys() and
+// std::stable_sort, group_tracks_sharded() against a serial std::map pass, and
+// parallel_for_chunks() on its own (coverage, exceptions, concurrent callers).
+// An explicit thread count is used even past the hardware threads, so the
+// parallel code runs on any machine.
+//
+//   parallel_order_test [--threads 1,2,4,8,16] [--bench] [--runs R]
+//
+// --bench also times every path at 500k keys / 400k tracks.
+
+#include <map>
+#include <thread>
+
+#include "radix_sort.h"
+#include "synthetic_library.h"
+#include "test_support.h"
+
+using namespace albumart_grid;
+using namespace albumart_grid_test;
+
+namespace {
+
+struct key_set {
+    std::string bytes;
+    std::vector<uint32_t> offsets{ 0 };
+
+    void add(const std::string& key) {
+        bytes += key;
+        offsets.push_back((uint32_t)bytes.size());
+    }
+    size_t size() const { return offsets.size() - 1; }
+    std::string key(size_t i) const { return bytes.substr(offsets[i], offsets[i + 1] - offsets[i]); }
+    radix_key_sorter sorter() const {
+        return radix_key_sorter(reinterpret_cast<const unsigned char*>(bytes.data()), offsets.data(), size());
+    }
+};
+
+// Sort keys shaped like sort_grid_items()'s: a shared year prefix for many,
+// folded names with common words, duplicates, empty keys and embedded NULs
+key_set make_keys(size_t count, uint64_t seed) {
+    synthetic_random random(seed);
+    key_set keys;
+    std::vector<std::string> earlier;
+    for (size_t i = 0; i < count; i++) {
+        std::string key;
+        const unsigned shape = random.between(0, 19);
+        if (shape == 0) {
+            // empty key
+        } else if (shape <= 2 && !earlier.empty()) {
+            key = earlier[random.between(0, (unsigned)earlier.size() - 1)];  // duplicate
+        } else {
+            if (shape <= 10) {
+                const unsigned year = random.between(1955, 2025);
+                key.push_back('\0');
+                key.push_back((char)(~year >> 8));
+                key.push_back((char)~year);
+            }
+            for (char c : synthetic_name(random, 4)) key.push_back(c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c);
+            key.push_back('\0');
+            key += std::to_string(random.between(0, 999));
+        }
+        if (earlier.size() < 4096) earlier.push_back(key);
+        keys.add(key);
+    }
+    return keys;
+}
+
+std::vector<uint32_t> stable_order(const key_set& keys) {
+    std::vector<std::string> text(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) text[i] = keys.key(i);
+    std::vector<uint32_t> order(keys.size());
+    for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&text](uint32_t a, uint32_t b) { return text[a] < text[b]; });
+    return order;
+}
+
+void test_sort(const std::vector<unsigned>& thread_counts) {
+    for (size_t count : { (size_t)1000, (size_t)40000, (size_t)150000 }) {
+        const key_set keys = make_keys(count, count);
+        const std::vector<uint32_t> expected = stable_order(keys);
+        CHECK(keys.sorter().sort_keys() == expected);
+        for (unsigned threads : thread_counts) CHECK(keys.sorter().sort_keys_parallel(threads) == expected);
+    }
+}
+
+struct key_less {
+    bool operator()(const std::string& a, const std::string& b) const { return group_key_less(a, b); }
+};
+
+// Album key as group_key_album builds it; tracks without an album are left out
+bool album_key(const synthetic_track& track, size_t index, std::string& key) {
+    if (index % 97 == 0) return false;
+    key.append(track.album_artist.empty() ? track.artist : track.album_artist).append(" - ").append(track.album);
+    return true;
+}
+
+std::vector<track_group> group_serial(const std::vector<synthetic_track>& tracks) {
+    std::map<std::string, std::vector<uint32_t>, key_less> groups;
+    std::string key;
+    for (size_t i = 0; i < tracks.size(); i++) {
+        key.clear();
+        if (album_key(tracks[i], i, key)) groups[key].push_back((uint32_t)i);
+    }
+    std::vector<track_group> out;
+    for (auto& group : groups) out.push_back(track_group{ group.first, std::move(group.second) });
+    return out;
+}
+
+std::vector<track_group> group_sharded(const std::vector<synthetic_track>& tracks, unsigned threads, size_t shard_size) {
+    grouping_options options;
+    options.max_threads = threads;
+    options.shard_size = shard_size;
+    return group_tracks_sharded(tracks.size(), [&tracks](size_t i, std::string& key) {
+        return album_key(tracks[i], i, key);
+    }, options);
+}
+
+bool same_groups(const std::vector<track_group>& a, const std::vector<track_group>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].key != b[i].key || a[i].members != b[i].members) return false;
+    }
+    return true;
+}
+
+void test_grouping(const std::vector<unsigned>& thread_counts) {
+    const std::vector<synthetic_track> tracks = make_synthetic_library(30000, 7);
+    const std::vector<track_group> expected = group_serial(tracks);
+    for (unsigned threads : thread_counts) {
+        for (size_t shard_size : { (size_t)1, (size_t)333, (size_t)2048, (size_t)100000 }) {
+            if (shard_size == 1 && threads > 4) continue;  // one shard per track: slow, nothing new
+            CHECK(same_groups(group_sharded(tracks, threads, shard_size), expected));
+        }
+    }
+    std::atomic<bool> cancel{ true };
+    grouping_options options;
+    options.max_threads = 4;
+    options.cancel = &cancel;
+    CHECK(group_tracks_sharded(tracks.size(), [&tracks](size_t i, std::string& key) {
+        return album_key(tracks[i], i, key);
+    }, options).empty());
+}
+
+void test_chunks(const std::vector<unsigned>& thread_counts) {
+    for (unsigned threads : thread_counts) {
+        for (size_t count : { (size_t)1, (size_t)7, (size_t)1000, (size_t)100003 }) {
+            for (size_t chunk : { (size_t)1, (size_t)64, (size_t)4096 }) {
+                if (chunk == 1 && count > 1000) continue;
+                std::vector<std::atomic<unsigned>> hits(count);
+                parallel_for_chunks(count, chunk, threads, [&](size_t begin, size_t end) {
+                    CHECK(begin < end && end <= count && (threads == 1 || end - begin <= chunk));
+                    for (size_t i = begin; i < end; i++) hits[i]++;
+                });
+                bool once = true;
+                for (auto& h : hits) once = once && h == 1;
+                CHECK(once);
+            }
+        }
+
+        // The first exception comes back after every chunk ran (one thread: one call)
+        std::atomic<size_t> ran{ 0 };
+        bool thrown = false;
+        try {
+            parallel_for_chunks(64, 1, threads, [&](size_t begin, size_t end) {
+                ran++;
+                if (begin <= 5 && 5 < end) throw std::runtime_error("chunk 5");
+            });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        CHECK(thrown && ran == (threads == 1 ? 1u : 64u));
+    }
+
+    // Several callers at once (the UI thread and a model pool build) share the
+    // helpers; a nested call must not wait on helpers its caller is using
+    std::vector<std::thread> callers;
+    std::atomic<size_t> total{ 0 };
+    for (unsigned c = 0; c < 4; c++) {
+        callers.emplace_back([&total] {
+            for (int round = 0; round < 50; round++) {
+                parallel_for_chunks(8, 1, 4, [&total](size_t, size_t) {
+                    parallel_for_chunks(100, 10, 4, [&total](size_t begin, size_t end) { total += end - begin; });
+                });
+            }
+        });
+    }
+    for (auto& t : callers) t.join();
+    CHECK(total == 4u * 50u * 8u * 100u);
+}
+
+void bench(const std::vector<unsigned>& thread_counts, int runs) {
+    std::printf("%u hardware threads\n", std::max(1u, std::thread::hardware_concurrency()));
+
+    const key_set keys = make_keys(500000, 5);
+    std::vector<uint32_t> serial;
+    const double sort_ms = best_ms(runs, [&] { serial = keys.sorter().sort_keys(); });
+    std::vector<uint32_t> stable;
+    const double stable_ms = best_ms(runs, [&] { stable = stable_order(keys); });
+    CHECK(serial == stable);
+    std::printf("500k keys  std::stable_sort %8.1f ms   sort_keys %8.1f ms\n", stable_ms, sort_ms);
+    for (unsigned threads : thread_counts) {
+        std::vector<uint32_t> parallel;
+        const double ms = best_ms(runs, [&] { parallel = keys.sorter().sort_keys_parallel(threads); });
+        CHECK(parallel == serial);
+        std::printf("           sort_keys_parallel, %2u threads %8.1f ms  (%.2fx)\n", threads, ms, sort_ms / ms);
+    }
+
+    const std::vector<synthetic_track> tracks = make_synthetic_library(400000, 5);
+    std::vector<track_group> expected;
+    const double map_ms = best_ms(runs, [&] { expected = group_serial(tracks); });
+    std::printf("400k tracks  std::map serial %8.1f ms (%zu groups)\n", map_ms, expected.size());
+    for (unsigned threads : thread_counts) {
+        std::vector<track_group> groups;
+        const double ms = best_ms(runs, [&] { groups = group_sharded(tracks, threads, 2048); });
+        CHECK(same_groups(groups, expected));
+        std::printf("             group_tracks_sharded, %2u threads %8.1f ms  (%.2fx)\n", threads, ms, map_ms / ms);
+    }
+
+    // What a library callback's delta costs to hand to the helpers
+    std::vector<uint32_t> sink(64);
+    for (size_t rows : { (size_t)64, (size_t)4096 }) {
+        const double ms = best_ms(runs, [&] {
+            for (int i = 0; i < 1000; i++) {
+                parallel_for_chunks(rows, 256, 4, [&sink](size_t begin, size_t) { sink[begin % 64]++; });
+            }
+        });
+        std::printf("parallel_for_chunks, %4zu rows in 256-row chunks, 4 threads: %6.1f us per call\n", rows, ms);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::vector<unsigned> thread_counts = number_list(flag_value(argc, argv, "--threads", "1,2,4,8,16"));
+    test_sort(thread_counts);
+    test_grouping(thread_counts);
+    test_chunks(thread_counts);
+    if (has_flag(argc, argv, "--bench")) bench(thread_counts, atoi(flag_value(argc, argv, "--runs", "3").c_str()));
+    return test_result("parallel_order_test");
+}
@@ -0,0 +1,191 @@
+// Benchmark of sort_grid_items()'s path - binary order keys, radix sorted
+// (src/core/radix_sort.h) - against the std::sort with pfc::stricmp_ascii over
+// unique_ptr<grid_item> that sort_items() used before, at 50k-500k groups.
+// The radix order is checked against std::stable_sort of the same keys.
+// sort_keys_parallel() is timed at each --threads count against sort_keys().
+//
+//   radix_sort_bench [--groups 50000,100000,200000,500000] [--threads 2,4,8,16]
+//                    [--runs R] [--quick]
+//
+// Recorded figures (best of 3, radix sort alone, by name / by year). The only
+// machine available so far has a single core (AVX2, GCC -O2), so these figures
+// show the cost of the split and no speedup. 8- and 16-core figures are still
+// to be recorded here.
+//
+//   groups    sort_keys()   parallel, 16 threads   old std::sort+stricmp
+//   32768     3.5 / 3.9 ms     3.8 / 4.1 ms           33.9 / 28.9 ms
+//   100000   11.5 / 9.2 ms     8.7 / 9.9 ms          143.4 / 92.0 ms
+//   500000   77.5 / 75.0 ms   80.5 / 69.4 ms         767.9 / 618.4 ms
+//
+// Since no fixed size showed a gain, sort_keys_parallel() has no size threshold
+// of its own. It splits only when there are threads and at least two tasks of
+// work; on one core it is sort_keys().
+//
+// Keys are built as in the component for ASCII text: folded name, NUL, raw
+// group key; sorting by year puts the four-digit year first, newest first.
+
+#include <cctype>
+#include <memory>
+
+#include "radix_sort.h"
+#include "synthetic_library.h"
+#include "test_support.h"
+
+using namespace albumart_grid;
+using namespace albumart_grid_test;
+
+namespace {
+
+struct item {
+    std::string name;   // display name, mixed case
+    std::string key;    // group key
+    std::string year;
+    std::string order_key;
+};
+
+std::vector<std::unique_ptr<item>> make_items(size_t count, uint64_t seed) {
+    synthetic_random random(seed);
+    std::vector<std::unique_ptr<item>> items;
+    items.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        auto it = std::make_unique<item>();
+        it->name = synthetic_name(random, 4);
+        if (random.between(0, 3) == 0) {
+            for (char& c : it->name) c = (char)toupper((unsigned char)c);
+        }
+        it->key = synthetic_name(random, 2) + " - " + it->name;
+        it->year = random.between(0, 20) == 0 ? std::string() : std::to_string(random.between(1955, 2025));
+        items.push_back(std::move(it));
+    }
+    return items;
+}
+
+int stricmp_ascii(const char* a, const char* b) {
+    for (;; a++, b++) {
+        const int ca = tolower((unsigned char)*a), cb = tolower((unsigned char)*b);
+        if (ca != cb || ca == 0) return ca - cb;
+    }
+}
+
+void append_folded(std::string& out, const std::string& text) {
+    for (char c : text) out.push_back(c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c);
+}
+
+void build_key(item& it, bool by_year) {
+    std::string& out = it.order_key;
+    out.clear();
+    if (by_year) {
+        if (it.year.size() == 4) {
+            out.push_back('\0');
+            const unsigned value = (unsigned)atoi(it.year.c_str());
+            out.push_back((char)(~value >> 8));  // descending
+            out.push_back((char)~value);
+        } else {
+            out.push_back('\2');
+        }
+    }
+    append_folded(out, it.name);
+    out.push_back('\0');
+    out.append(it.key);
+}
+
+// sort_items() before: comparisons fold case again every time
+void sort_before(std::vector<std::unique_ptr<item>>& items, bool by_year) {
+    std::sort(items.begin(), items.end(), [by_year](const std::unique_ptr<item>& a, const std::unique_ptr<item>& b) {
+        if (by_year && a->year != b->year) return a->year > b->year;
+        return stricmp_ascii(a->name.c_str(), b->name.c_str()) < 0;
+    });
+}
+
+// sort_grid_items() now; sort_ms gets the radix sort alone. threads 0 is
+// sort_keys(), anything else sort_keys_parallel() with at most that many threads.
+void sort_after(std::vector<std::unique_ptr<item>>& items, bool by_year, double* sort_ms, unsigned threads = 0) {
+    for (auto& it : items) build_key(*it, by_year);
+    std::vector<uint32_t> offsets;
+    offsets.reserve(items.size() + 1);
+    offsets.push_back(0);
+    size_t total = 0;
+    for (const auto& it : items) {
+        total += it->order_key.size();
+        offsets.push_back((uint32_t)total);
+    }
+    std::vector<unsigned char> bytes(total);
+    for (size_t i = 0; i < items.size(); i++) {
+        memcpy(bytes.data() + offsets[i], items[i]->order_key.data(), items[i]->order_key.size());
+    }
+    radix_key_sorter sorter(bytes.data(), offsets.data(), items.size());
+    std::vector<uint32_t> order;
+    const double took = best_ms(1, [&] { order = threads ? sorter.sort_keys_parallel(threads) : sorter.sort_keys(); });
+    if (sort_ms) *sort_ms = took;
+    std::vector<std::unique_ptr<item>> sorted;
+    sorted.reserve(items.size());
+    for (uint32_t index : order) sorted.push_back(std::move(items[index]));
+    items.swap(sorted);
+}
+
+std::vector<std::unique_ptr<item>> copy_items(const std::vector<std::unique_ptr<item>>& items) {
+    std::vector<std::unique_ptr<item>> copy;
+    copy.reserve(items.size());
+    for (const auto& it : items) copy.push_back(std::make_unique<item>(*it));
+    return copy;
+}
+
+// The radix order is std::stable_sort's order of the same keys
+void check_order(const std::vector<std::unique_ptr<item>>& items, bool by_year) {
+    std::vector<std::string> keys;
+    std::vector<uint32_t> offsets{ 0 };
+    std::string bytes;
+    for (const auto& it : items) {
+        item copy = *it;
+        build_key(copy, by_year);
+        bytes += copy.order_key;
+        offsets.push_back((uint32_t)bytes.size());
+        keys.push_back(copy.order_key);
+    }
+    std::vector<uint32_t> expected(items.size());
+    for (uint32_t i = 0; i < expected.size(); i++) expected[i] = i;
+    std::stable_sort(expected.begin(), expected.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    radix_key_sorter sorter(reinterpret_cast<const unsigned char*>(bytes.data()), offsets.data(), items.size());
+    CHECK(sorter.sort_keys() == expected);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = has_flag(argc, argv, "--quick");
+    const std::vector<unsigned> group_counts = number_list(flag_value(argc, argv, "--groups", quick ? "1000,20000" : "50000,100000,200000,500000"));
+    const int runs = quick ? 1 : atoi(flag_value(argc, argv, "--runs", "3").c_str());
+    const std::vector<unsigned> thread_counts = number_list(flag_value(argc, argv, "--threads", quick ? "2" : "2,4,8,16"));
+
+    for (unsigned count : group_counts) {
+        const auto items = make_items(count, count);
+        for (bool by_year : { false, true }) {
+            check_order(items, by_year);
+            // Best of runs, each on a fresh copy; only the sort itself is timed
+            double before = 1e300, after = 1e300, radix = 1e300;
+            for (int r = 0; r < runs; r++) {
+                auto work = copy_items(items);
+                before = std::min(before, best_ms(1, [&] { sort_before(work, by_year); }));
+                work = copy_items(items);
+                double sort_only = 0;
+                after = std::min(after, best_ms(1, [&] { sort_after(work, by_year, &sort_only); }));
+                radix = std::min(radix, sort_only);
+            }
+            std::printf("%7u groups by %-4s  std::sort+stricmp %8.1f ms   keys+radix %8.1f ms (radix alone %6.1f ms)  %.2fx\n",
+                count, by_year ? "year" : "name", before, after, radix, before / after);
+            // sort_keys_parallel() against the sequential radix sort and the old sort
+            for (unsigned threads : thread_counts) {
+                double parallel = 1e300;
+                for (int r = 0; r < runs; r++) {
+                    auto work = copy_items(items);
+                    double sort_only = 0;
+                    sort_after(work, by_year, &sort_only, threads);
+                    parallel = std::min(parallel, sort_only);
+                }
+                std::printf("%7u groups by %-4s  radix on %2u threads %6.1f ms  %.2fx radix alone, %.2fx std::sort+stricmp\n",
+                    count, by_year ? "year" : "name", threads, parallel, radix / parallel, before / parallel);
+            }
+        }
+    }
+    return test_result("radix_sort_bench");
+}
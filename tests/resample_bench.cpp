@@ -0,0 +1,172 @@
+// Benchmark of resample_thumbnail() (src/core/resample.h) on cover-sized
+// sources, per ISA. On Windows it is timed against what create_thumbnail()
+// did before: GDI+ DrawImage with HighQualityBicubic into a PARGB bitmap, set
+// up as the component did. Elsewhere GDI+ is not available; a plain float
+// bicubic (per-pixel weights, no SIMD) stands in to show what the fixed-point
+// separable passes save, and its numbers say nothing about GDI+ itself.
+//
+//   resample_bench [--runs R] [--quick]
+
+#include <cmath>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <objidl.h>
+#include <gdiplus.h>
+#endif
+
+#include "resample.h"
+#include "synthetic_library.h"
+#include "test_support.h"
+
+using namespace albumart_grid;
+using namespace albumart_grid_test;
+
+namespace {
+
+std::vector<uint8_t> make_cover(int width, int height) {
+    synthetic_random random((uint64_t)width * 31 + height);
+    std::vector<uint8_t> pixels((size_t)width * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = &pixels[((size_t)y * width + x) * 4];
+            // Smooth gradients with some noise, opaque like nearly every cover
+            p[0] = (uint8_t)((x * 255 / width + random.between(0, 15)) & 255);
+            p[1] = (uint8_t)((y * 255 / height + random.between(0, 15)) & 255);
+            p[2] = (uint8_t)(((x + y) * 127 / (width + height) + random.between(0, 15)) & 255);
+            p[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+double keys_cubic(double x) {
+    x = std::fabs(x);
+    if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+// Float bicubic, widened when shrinking; weights worked out per output pixel
+void float_bicubic(const uint8_t* src, int sw, int sh, uint8_t* dst, int dw, int dh) {
+    const double sx = (double)sw / dw, sy = (double)sh / dh;
+    const double wx = std::max(1.0, sx), wy = std::max(1.0, sy);
+    std::vector<float> rows((size_t)dw * sh * 4);
+    for (int y = 0; y < sh; y++) {
+        for (int x = 0; x < dw; x++) {
+            const double center = (x + 0.5) * sx - 0.5;
+            const int lo = std::max(0, (int)std::floor(center - 2 * wx)), hi = std::min(sw - 1, (int)std::ceil(center + 2 * wx));
+            float acc[4] = {}, total = 0;
+            for (int i = lo; i <= hi; i++) {
+                const float w = (float)keys_cubic((i - center) / wx);
+                const uint8_t* p = src + ((size_t)y * sw + i) * 4;
+                for (int ch = 0; ch < 4; ch++) acc[ch] += w * p[ch];
+                total += w;
+            }
+            for (int ch = 0; ch < 4; ch++) rows[((size_t)y * dw + x) * 4 + ch] = acc[ch] / total;
+        }
+    }
+    for (int y = 0; y < dh; y++) {
+        const double center = (y + 0.5) * sy - 0.5;
+        const int lo = std::max(0, (int)std::floor(center - 2 * wy)), hi = std::min(sh - 1, (int)std::ceil(center + 2 * wy));
+        for (int x = 0; x < dw; x++) {
+            float acc[4] = {}, total = 0;
+            for (int i = lo; i <= hi; i++) {
+                const float w = (float)keys_cubic((i - center) / wy);
+                const float* p = &rows[((size_t)i * dw + x) * 4];
+                for (int ch = 0; ch < 4; ch++) acc[ch] += w * p[ch];
+                total += w;
+            }
+            for (int ch = 0; ch < 4; ch++) {
+                const float v = acc[ch] / total;
+                dst[((size_t)y * dw + x) * 4 + ch] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v + 0.5f);
+            }
+        }
+    }
+}
+
+#ifdef _WIN32
+// create_thumbnail()'s DrawImage set-up from before resample_bitmap()
+double gdiplus_ms(std::vector<uint8_t>& cover, int sw, int sh, int dw, int dh, int runs) {
+    Gdiplus::Bitmap source(sw, sh, sw * 4, PixelFormat32bppPARGB, cover.data());
+    Gdiplus::Bitmap target(dw, dh, PixelFormat32bppPARGB);
+    return best_ms(runs, [&] {
+        Gdiplus::Graphics graphics(&target);
+        graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
+        graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
+        graphics.SetPixelOffsetMode(Gdiplus::PixelOffsetModeHalf);
+        graphics.SetCompositingQuality(Gdiplus::CompositingQualityHighQuality);
+        graphics.DrawImage(&source, 0, 0, dw, dh);
+    });
+}
+#endif
+
+const char* isa_name(resample_isa isa) {
+    switch (isa) {
+        case resample_isa::scalar: return "scalar";
+        case resample_isa::sse2: return "SSE2";
+        case resample_isa::avx2: return "AVX2";
+    }
+    return "";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = has_flag(argc, argv, "--quick");
+    const int runs = quick ? 1 : atoi(flag_value(argc, argv, "--runs", "5").c_str());
+#ifdef _WIN32
+    Gdiplus::GdiplusStartupInput startup_input;
+    ULONG_PTR gdiplus_token = 0;
+    Gdiplus::GdiplusStartup(&gdiplus_token, &startup_input, nullptr);
+#endif
+
+    std::vector<resample_isa> isas{ resample_isa::scalar };
+#if ALBUMART_RESAMPLE_X86
+    isas.push_back(resample_isa::sse2);
+    if (best_resample_isa() == resample_isa::avx2) isas.push_back(resample_isa::avx2);
+#endif
+
+    static const int jobs[][4] = {
+        { 500, 500, 150, 150 }, { 1000, 1000, 150, 150 }, { 1400, 1400, 250, 250 }, { 3000, 3000, 150, 150 }, { 3000, 3000, 400, 400 },
+    };
+    for (const auto& job : jobs) {
+        const int sw = quick ? job[0] / 4 : job[0], sh = quick ? job[1] / 4 : job[1], dw = job[2], dh = job[3];
+        std::vector<uint8_t> cover = make_cover(sw, sh);
+        const pixel_view src = { cover.data(), sw, sh, (ptrdiff_t)sw * 4 };
+        std::vector<uint8_t> out((size_t)dw * dh * 4), reference_out(out.size());
+        const pixel_target dst = { out.data(), dw, dh, (ptrdiff_t)dw * 4 };
+
+        const double reference = best_ms(runs, [&] { float_bicubic(cover.data(), sw, sh, reference_out.data(), dw, dh); });
+        std::printf("%4dx%-4d -> %3dx%-3d  float bicubic %7.2f ms", sw, sh, dw, dh, reference);
+#ifdef _WIN32
+        const double gdiplus = gdiplus_ms(cover, sw, sh, dw, dh, runs);
+        std::printf("  GDI+ %7.2f ms", gdiplus);
+#endif
+        std::vector<uint8_t> first;
+        for (resample_isa isa : isas) {
+            const double ms = best_ms(runs, [&] { resample_thumbnail(src, dst, isa); });
+            if (first.empty()) first = out;
+            CHECK(out == first);
+#ifdef _WIN32
+            std::printf("  %s %6.2f ms (%.1fx GDI+)", isa_name(isa), ms, gdiplus / ms);
+#else
+            std::printf("  %s %6.2f ms (%.1fx)", isa_name(isa), ms, reference / ms);
+#endif
+        }
+        std::printf("\n");
+
+        // Both are smoothing filters of the same image: far apart means a broken pass
+        double error = 0;
+        for (size_t i = 0; i < out.size(); i++) error += std::fabs((double)out[i] - reference_out[i]);
+        CHECK(error / (double)out.size() < 8.0);
+    }
+
+#ifdef _WIN32
+    Gdiplus::GdiplusShutdown(gdiplus_token);
+#endif
+    return test_result("resample_bench");
+}
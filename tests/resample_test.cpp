@@ -0,0 +1,168 @@
+// Checks of src/core/resample.h: the scalar, SSE2 and AVX2 paths give
+// bit-identical output, a flat colour stays exactly that colour, and no
+// premultiplied channel ends up above its alpha. ISAs the CPU lacks are
+// skipped (and reported).
+
+#include "resample.h"
+#include "synthetic_library.h"
+#include "test_support.h"
+
+using namespace albumart_grid;
+using namespace albumart_grid_test;
+
+namespace {
+
+struct image {
+    int width;
+    int height;
+    ptrdiff_t stride;
+    std::vector<uint8_t> pixels;
+
+    // Rows padded past the width, as LockBits strides may be
+    image(int w, int h) : width(w), height(h), stride((ptrdiff_t)w * 4 + 12), pixels((size_t)stride * h, 0xCD) {}
+
+    pixel_view view() const { return pixel_view{ pixels.data(), width, height, stride }; }
+    pixel_target target() { return pixel_target{ pixels.data(), width, height, stride }; }
+    uint8_t* at(int x, int y) { return pixels.data() + y * stride + x * 4; }
+    const uint8_t* at(int x, int y) const { return pixels.data() + y * stride + x * 4; }
+};
+
+// Noise with hard alpha edges: opaque, transparent and translucent blocks
+image make_cover(int width, int height, uint64_t seed) {
+    synthetic_random random(seed);
+    image img(width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const unsigned block = ((x / 7) + (y / 5)) % 4;
+            const uint8_t alpha = block == 0 ? 0 : block == 1 ? (uint8_t)random.between(1, 254) : 255;
+            uint8_t* p = img.at(x, y);
+            for (int ch = 0; ch < 3; ch++) p[ch] = (uint8_t)random.between(0, alpha);
+            p[3] = alpha;
+        }
+    }
+    return img;
+}
+
+enum class method { area, lanczos3, thumbnail };
+
+void run(const image& src, image& dst, method m, resample_isa isa) {
+    if (m == method::thumbnail) {
+        resample_thumbnail(src.view(), dst.target(), isa);
+    } else {
+        resample(src.view(), dst.target(), m == method::area ? resample_filter::area : resample_filter::lanczos3, isa);
+    }
+}
+
+// Padding included: no path may write past the width
+bool same_pixels(const image& a, const image& b) { return a.pixels == b.pixels; }
+
+bool premultiplied(const image& img) {
+    for (int y = 0; y < img.height; y++) {
+        for (int x = 0; x < img.width; x++) {
+            const uint8_t* p = img.at(x, y);
+            if (p[0] > p[3] || p[1] > p[3] || p[2] > p[3]) return false;
+        }
+    }
+    return true;
+}
+
+bool padding_untouched(const image& img) {
+    for (int y = 0; y < img.height; y++) {
+        for (ptrdiff_t i = (ptrdiff_t)img.width * 4; i < img.stride; i++) {
+            if (img.pixels[y * img.stride + i] != 0xCD) return false;
+        }
+    }
+    return true;
+}
+
+const int sizes[][4] = {
+    { 3000, 3000, 150, 150 }, { 1423, 997, 151, 106 }, { 1000, 700, 250, 175 }, { 600, 600, 128, 128 },
+    { 375, 375, 150, 150 }, { 256, 256, 256, 256 }, { 40, 40, 39, 13 }, { 17, 9, 5, 3 },
+    { 150, 150, 300, 300 }, { 5, 3, 17, 9 }, { 1, 1, 3, 3 }, { 3, 1, 1, 1 }, { 33, 65, 7, 1 },
+};
+
+std::vector<resample_isa> supported_isas() {
+    std::vector<resample_isa> isas{ resample_isa::scalar };
+#if ALBUMART_RESAMPLE_X86
+    isas.push_back(resample_isa::sse2);
+    if (best_resample_isa() == resample_isa::avx2) isas.push_back(resample_isa::avx2);
+#endif
+    return isas;
+}
+
+void test_isas_agree() {
+    const std::vector<resample_isa> isas = supported_isas();
+    std::printf("comparing %zu of 3 ISAs (scalar%s%s)\n", isas.size(), isas.size() > 1 ? ", SSE2" : "", isas.size() > 2 ? ", AVX2" : "");
+    uint64_t seed = 1;
+    for (const auto& s : sizes) {
+        const image src = make_cover(s[0], s[1], seed++);
+        for (method m : { method::area, method::lanczos3, method::thumbnail }) {
+            image reference(s[2], s[3]);
+            run(src, reference, m, resample_isa::scalar);
+            CHECK(padding_untouched(reference));
+            CHECK(premultiplied(reference));
+            for (size_t i = 1; i < isas.size(); i++) {
+                image out(s[2], s[3]);
+                run(src, out, m, isas[i]);
+                if (!same_pixels(reference, out)) {
+                    std::fprintf(stderr, "%dx%d -> %dx%d, method %d, isa %d differs from scalar\n", s[0], s[1], s[2], s[3], (int)m, (int)isas[i]);
+                    CHECK(false);
+                }
+            }
+        }
+    }
+}
+
+void test_flat_colour() {
+    // Opaque, translucent (premultiplied) and fully transparent
+    const uint8_t colours[][4] = { { 10, 200, 77, 255 }, { 0, 255, 255, 255 }, { 40, 100, 7, 128 }, { 1, 1, 1, 1 }, { 0, 0, 0, 0 } };
+    for (const auto& colour : colours) {
+        for (const auto& s : sizes) {
+            image src(s[0], s[1]);
+            for (int y = 0; y < src.height; y++) {
+                for (int x = 0; x < src.width; x++) memcpy(src.at(x, y), colour, 4);
+            }
+            for (resample_isa isa : supported_isas()) {
+                for (method m : { method::area, method::lanczos3, method::thumbnail }) {
+                    image out(s[2], s[3]);
+                    run(src, out, m, isa);
+                    bool flat = true;
+                    for (int y = 0; y < out.height; y++) {
+                        for (int x = 0; x < out.width; x++) flat = flat && memcmp(out.at(x, y), colour, 4) == 0;
+                    }
+                    CHECK(flat);
+                }
+            }
+        }
+    }
+}
+
+// Lanczos lobes overshoot most at a hard edge between a bright translucent
+// area and a dark opaque one
+void test_premultiplied_edges() {
+    for (const auto& s : sizes) {
+        image src(s[0], s[1]);
+        for (int y = 0; y < src.height; y++) {
+            for (int x = 0; x < src.width; x++) {
+                static const uint8_t bright[4] = { 60, 60, 60, 60 }, dark[4] = { 0, 0, 0, 255 };
+                memcpy(src.at(x, y), ((x / 2) + (y / 3)) % 2 ? bright : dark, 4);
+            }
+        }
+        for (resample_isa isa : supported_isas()) {
+            for (method m : { method::area, method::lanczos3, method::thumbnail }) {
+                image out(s[2], s[3]);
+                run(src, out, m, isa);
+                CHECK(premultiplied(out));
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_isas_agree();
+    test_flat_colour();
+    test_premultiplied_edges();
+    return test_result("resample_test");
+}
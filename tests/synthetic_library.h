@@ -0,0 +1,105 @@
+#pragma once
+
+// Stand-in for the foobar2000 metadb in the headless benchmarks: a library of
+// tracks generated from a seed, shaped like a real collection. Artists have a
+// few albums of 8-20 tracks, each album in its own folder. Some albums span
+// discs in "Disc N" subfolders, and some are compilations whose tracks each
+// have their own artist under one album artist.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace albumart_grid_test {
+
+struct synthetic_track {
+    std::string artist;
+    std::string album_artist;  // empty unless the album is a compilation
+    std::string album;
+    std::string title;
+    std::string date;
+    std::string genre;
+    std::string path;
+};
+
+// xorshift64*, so a seed gives the same library on every platform
+class synthetic_random {
+public:
+    explicit synthetic_random(uint64_t seed) : m_state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+
+    uint64_t next() {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1DULL;
+    }
+
+    // Uniform in [low, high]
+    unsigned between(unsigned low, unsigned high) { return low + (unsigned)(next() % (high - low + 1)); }
+
+private:
+    uint64_t m_state;
+};
+
+inline std::string synthetic_word(synthetic_random& random) {
+    static const char* const syllables[] = {
+        "an", "bel", "cor", "da", "el", "fen", "gar", "hol", "is", "jun", "ka", "lor", "mo", "nor",
+        "o", "pa", "quin", "ra", "sol", "ta", "ul", "ven", "wy", "xan", "yo", "zer",
+    };
+    std::string word;
+    const unsigned count = random.between(1, 3);
+    for (unsigned i = 0; i < count; i++) word += syllables[random.between(0, 25)];
+    word[0] = (char)(word[0] - 'a' + 'A');
+    return word;
+}
+
+inline std::string synthetic_name(synthetic_random& random, unsigned max_words) {
+    std::string name = synthetic_word(random);
+    const unsigned words = random.between(1, max_words);
+    for (unsigned i = 1; i < words; i++) name += " " + synthetic_word(random);
+    return name;
+}
+
+// About track_count tracks (the last album is cut off there)
+inline std::vector<synthetic_track> make_synthetic_library(size_t track_count, uint64_t seed = 1) {
+    static const char* const genres[] = { "Rock", "Jazz", "Electronic", "Classical", "Folk", "Hip Hop", "Ambient", "Metal" };
+    synthetic_random random(seed);
+    std::vector<synthetic_track> tracks;
+    tracks.reserve(track_count);
+    while (tracks.size() < track_count) {
+        const bool compilation = random.between(0, 9) == 0;
+        const std::string artist = compilation ? std::string("Various Artists") + " " + synthetic_word(random) : synthetic_name(random, 3);
+        const unsigned albums = compilation ? 1 : random.between(1, 6);
+        for (unsigned a = 0; a < albums && tracks.size() < track_count; a++) {
+            const std::string album = synthetic_name(random, 4);
+            const std::string date = std::to_string(random.between(1955, 2025));
+            const char* genre = genres[random.between(0, 7)];
+            const std::string folder = "D:\\Music\\" + (compilation ? std::string("Compilations") : artist) + "\\" + date + " - " + album;
+            const unsigned discs = random.between(0, 7) == 0 ? random.between(2, 4) : 1;
+            for (unsigned d = 1; d <= discs && tracks.size() < track_count; d++) {
+                const std::string disc_folder = discs > 1 ? folder + "\\Disc " + std::to_string(d) : folder;
+                const unsigned count = random.between(8, 20);
+                for (unsigned t = 1; t <= count && tracks.size() < track_count; t++) {
+                    synthetic_track track;
+                    track.artist = compilation ? synthetic_name(random, 2) : artist;
+                    if (compilation) track.album_artist = artist;
+                    track.album = album;
+                    track.title = synthetic_name(random, 5);
+                    track.date = date;
+                    track.genre = genre;
+                    track.path = disc_folder + "\\" + (t < 10 ? "0" : "") + std::to_string(t) + " " + track.title + ".flac";
+                    tracks.push_back(std::move(track));
+                }
+            }
+        }
+    }
+    return tracks;
+}
+
+// Directory part of a path, as grouping by folder sees it
+inline std::string synthetic_directory(const std::string& path) {
+    const size_t slash = path.find_last_of('\\');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash);
+}
+
+} // namespace albumart_grid_test
@@ -0,0 +1,81 @@
+#pragma once
+
+// Checks and timing shared by the headless tests and benchmarks. A failed
+// CHECK reports and carries on; test_result() turns the count into the exit
+// code ctest looks at.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace albumart_grid_test {
+
+inline int& failure_count() {
+    static int count = 0;
+    return count;
+}
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            albumart_grid_test::failure_count()++;                                         \
+        }                                                                                  \
+    } while (0)
+
+inline int test_result(const char* name) {
+    if (failure_count() == 0) {
+        std::printf("%s: all checks passed\n", name);
+        return 0;
+    }
+    std::printf("%s: %d checks failed\n", name, failure_count());
+    return 1;
+}
+
+// Fastest of runs calls of fn, in milliseconds
+template <typename Fn>
+double best_ms(int runs, Fn&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < runs; r++) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+        best = std::min(best, took.count());
+    }
+    return best;
+}
+
+// True if argv holds flag (e.g. "--quick")
+inline bool has_flag(int argc, char** argv, const char* flag) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], flag) == 0) return true;
+    }
+    return false;
+}
+
+// Value after "--name", or fallback
+inline std::string flag_value(int argc, char** argv, const char* name, const char* fallback) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return argv[i + 1];
+    }
+    return fallback;
+}
+
+// Comma-separated unsigned numbers, e.g. "1,2,4,8,16"
+inline std::vector<unsigned> number_list(const std::string& text) {
+    std::vector<unsigned> numbers;
+    size_t at = 0;
+    while (at < text.size()) {
+        size_t comma = text.find(',', at);
+        if (comma == std::string::npos) comma = text.size();
+        if (comma > at) numbers.push_back((unsigned)strtoul(text.substr(at, comma - at).c_str(), nullptr, 10));
+        at = comma + 1;
+    }
+    return numbers;
+}
+
+} // namespace albumart_grid_test